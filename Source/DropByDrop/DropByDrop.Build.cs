@@ -45,6 +45,7 @@ public class DropByDrop : ModuleRules
 				"SlateCore", 
 				"LandscapeEditor",
 				"Landscape",
+				"ImageWrapper",
 				"LevelEditor"
 				
 				// ... add private dependencies that you statically link with here ...	
@@ -10,6 +10,11 @@ FHeightMapGenerationSettings& ULandscapeInfoComponent::GetHeightMapSettings()
 	return HeightMapSettings;
 }
 
+const FHeightMapGenerationSettings& ULandscapeInfoComponent::GetHeightMapSettings() const
+{
+	return HeightMapSettings;
+}
+
 /**
  * Sets new heightmap generation settings by copying the provided settings.
  */
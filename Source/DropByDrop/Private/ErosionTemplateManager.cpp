@@ -78,6 +78,7 @@ void UErosionTemplateManager::SaveCurrentAsTemplate(const FString& Name)
 	if (!UPipelineLibrary::SaveErosionTemplate(
 		Name,
 		ErosionSettings->ErosionCycles,
+		ErosionSettings->ErosionSeed,
 		ErosionSettings->Inertia,
 		ErosionSettings->Capacity,
 		ErosionSettings->MinimalSlope,
@@ -2,19 +2,463 @@
 
 #include "Libraries/ErosionLibrary.h"
 
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
 #include "DropByDropSettings.h"
 #include "DropByDropLogger.h"
+#include "Misc/Paths.h"
+
+// Minimum number of drops simulated by the parallel erosion between two shifts of the tile grid.
+#define PARALLEL_EROSION_MIN_DROPS_PER_ROUND 16384
+
+// Average number of drops simulated by each tile during a single parallel round.
+#define PARALLEL_EROSION_DROPS_PER_TILE 256
+
+// Drops simulated by the serial erosion between two progress updates (multiple of the SIMD batch size).
+#define EROSION_PROGRESS_DROPS_PER_BATCH 4096
+
+// Largest erosion radius with a compile-time specialized kernel.
+#define MAX_SPECIALIZED_EROSION_RADIUS 8
+
+// Template argument selecting the generic kernel, which reads the radius from the brush.
+#define GENERIC_EROSION_RADIUS -1
+
+// Minimum number of tiles kept in memory by the out-of-core erosion (a window spans up to 3x3 tiles).
+#define EROSION_TILE_CACHE_MIN_TILES 9
+
+// Folder, inside the project "Saved" directory, holding the tile files of the out-of-core erosion.
+#define EROSION_TILE_FILE_DIRECTORY "DropByDrop/Erosion"
+
+// Drops simulated by each run of the erosion benchmark, unless given to the console command.
+#define EROSION_BENCHMARK_DROPS 1000000
+
+// Side, in vertices, of the cells the stratified spawn places one drop in per pass.
+#define STRATIFIED_SPAWN_CELL_SIZE 8
+
+// Side, in vertices, of the cells of the importance spawn distribution.
+#define IMPORTANCE_SPAWN_CELL_SIZE 4
+
+// Seconds between two checks of the time budget: the serial erosion sizes its batches of drops to last about this long.
+#define EROSION_TIME_BUDGET_CHECK_INTERVAL 0.1
+
+// Fewest drops in a batch sized from the time budget.
+#define EROSION_TIME_BUDGET_MIN_DROPS 256
+
+// Smallest side, in vertices, of the coarsest level of the multiresolution erosion.
+#define MULTIRESOLUTION_MIN_LEVEL_SIZE 64
+
+// Weight of the latest batch in the moving average of the height change tracked by the adaptive erosion.
+#define EROSION_CONVERGENCE_SMOOTHING 0.25
+
+// Share of the importance spawn distribution spread uniformly, so every cell can be picked and no drop gets more than 1 / share water.
+#define IMPORTANCE_SPAWN_UNIFORM_FRACTION 0.1
+
+/**
+ * Number of cells of the brush built by "BuildErosionBrush" for the given radius.
+ * Must follow the same rule: cells with a positive weight, or the drop cell alone.
+ */
+static constexpr int32 GetErosionBrushSize(const int32 Radius)
+{
+	int32 Size = 0;
+
+	for (int32 Y = -Radius; Y <= Radius; Y++)
+	{
+		for (int32 X = -Radius; X <= Radius; X++)
+		{
+			Size += Radius * Radius - (X * X + Y * Y) > 0 ? 1 : 0;
+		}
+	}
+
+	return Size > 0 ? Size : 1;
+}
+
+/**
+ * Interleaves the bits of the coordinates (X in the even bits, Y in the odd ones),
+ * so sorting by the code walks the plane along a Z-order (Morton) curve.
+ */
+static uint32 GetMortonCode(const uint32 X, const uint32 Y)
+{
+	auto SpreadBits = [](uint32 Value)
+		{
+			Value &= 0x0000FFFF;
+			Value = (Value | (Value << 8)) & 0x00FF00FF;
+			Value = (Value | (Value << 4)) & 0x0F0F0F0F;
+			Value = (Value | (Value << 2)) & 0x33333333;
+			Value = (Value | (Value << 1)) & 0x55555555;
+			return Value;
+		};
+
+	return SpreadBits(X) | (SpreadBits(Y) << 1);
+}
+
+/**
+ * Keys the stream on both the seed and the drop index.
+ * The index is mixed after the seed, so neighbouring drops get uncorrelated states.
+ */
+FErosionRandomStream::FErosionRandomStream(const int32 Seed, const int64 DropIndex)
+	: State(static_cast<uint32>(Seed))
+{
+	State = Next() ^ static_cast<uint64>(DropIndex);
+	State = Next();
+}
+
+/**
+ * "SplitMix64" step: increments the counter by the golden ratio and scrambles it.
+ */
+uint64 FErosionRandomStream::Next()
+{
+	State += 0x9E3779B97F4A7C15ull;
+
+	uint64 Z = State;
+	Z = (Z ^ (Z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	Z = (Z ^ (Z >> 27)) * 0x94D049BB133111EBull;
+
+	return Z ^ (Z >> 31);
+}
+
+/**
+ * Uses the top 24 bits, exactly representable by a float.
+ */
+float FErosionRandomStream::GetFraction()
+{
+	return static_cast<float>(Next() >> 40) * (1.f / 16777216.f);
+}
+
+float FErosionRandomStream::FRandRange(const float Min, const float Max)
+{
+	return Min + (Max - Min) * GetFraction();
+}
+
+int32 FErosionRandomStream::RandHelper(const int32 Max)
+{
+	return Max > 0 ? static_cast<int32>((Next() >> 32) % static_cast<uint64>(Max)) : 0;
+}
+
+#pragma region TileCache
+
+FErosionTileCache::~FErosionTileCache()
+{
+	Close();
+}
+
+/**
+ * Creates the tile file and sizes the cache to the memory budget.
+ * Tiles are stored row by row, each one full size even if it crosses the grid border,
+ * the modified copies after all the original tiles.
+ */
+bool FErosionTileCache::Open(const FString& InFilePath, const FIntPoint& InGridSize, const int32 InTileSize, const int64 MemoryBudget)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(InFilePath));
+
+	FileHandle.Reset(PlatformFile.OpenWrite(*InFilePath, false, true));
+	if (!FileHandle.IsValid())
+	{
+		UE_LOG(LogDropByDropErosion, Error, TEXT("Unable to create the erosion tile file \"%s\"!"), *InFilePath);
+		return false;
+	}
+
+	FilePath = InFilePath;
+	GridSize = InGridSize;
+	TileSize = InTileSize;
+	TileCount = FIntPoint(FMath::DivideAndRoundUp(GridSize.X, TileSize), FMath::DivideAndRoundUp(GridSize.Y, TileSize));
+
+	// Never less than the tiles spanned by a single window, never more than the whole grid.
+	const int64 TileBytes = static_cast<int64>(TileSize) * TileSize * sizeof(float);
+	const int64 BudgetTiles = FMath::Max<int64>(MemoryBudget / TileBytes, EROSION_TILE_CACHE_MIN_TILES);
+	MaxResidentTiles = static_cast<int32>(FMath::Min<int64>(BudgetTiles, static_cast<int64>(TileCount.X) * TileCount.Y));
+
+	ResidentTiles.Reset(MaxResidentTiles);
+	ResidentSlots.Reset();
+	StoredTiles.Init(false, TileCount.X * TileCount.Y);
+	UseClock = 0;
+	Hits = 0;
+	Misses = 0;
+
+	return true;
+}
+
+/**
+ * The tile file is a scratch copy of the heights, so nothing is written back before deleting it.
+ */
+void FErosionTileCache::Close()
+{
+	if (!FileHandle.IsValid())
+	{
+		return;
+	}
+
+	FileHandle.Reset();
+	FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FilePath);
+
+	ResidentTiles.Empty();
+	ResidentSlots.Empty();
+	StoredTiles.Empty();
+}
+
+/**
+ * Writes the tiles in file order through a single tile buffer, the cache is bypassed and emptied.
+ */
+bool FErosionTileCache::WriteHeights(TConstArrayView<float> Heights)
+{
+	check(Heights.Num() == static_cast<int64>(GridSize.X) * GridSize.Y);
+
+	ResidentTiles.Reset();
+	ResidentSlots.Reset();
+	StoredTiles.Init(false, TileCount.X * TileCount.Y);
+
+	// Cells past the grid border are never read, zero them to keep the file deterministic.
+	TArray<float> TileHeights;
+	TileHeights.SetNumZeroed(TileSize * TileSize);
+
+	if (!FileHandle->Seek(0))
+	{
+		return false;
+	}
+
+	for (int32 TileY = 0; TileY < TileCount.Y; TileY++)
+	{
+		for (int32 TileX = 0; TileX < TileCount.X; TileX++)
+		{
+			const FIntPoint TileMin(TileX * TileSize, TileY * TileSize);
+			const int32 Width = FMath::Min(TileSize, GridSize.X - TileMin.X);
+			const int32 Height = FMath::Min(TileSize, GridSize.Y - TileMin.Y);
+
+			for (int32 Y = 0; Y < Height; Y++)
+			{
+				FMemory::Memcpy(TileHeights.GetData() + Y * TileSize, Heights.GetData() + (TileMin.Y + Y) * GridSize.X + TileMin.X, Width * sizeof(float));
+			}
+
+			if (!FileHandle->Write(reinterpret_cast<const uint8*>(TileHeights.GetData()), TileHeights.Num() * sizeof(float)))
+			{
+				UE_LOG(LogDropByDropErosion, Error, TEXT("Unable to write the erosion tile file \"%s\"!"), *FilePath);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FErosionTileCache::ReadHeights(TArray<float>& OutHeights)
+{
+	OutHeights.SetNumUninitialized(GridSize.X * GridSize.Y);
+	return CopyRegion(FIntRect(FIntPoint::ZeroValue, GridSize), OutHeights.GetData(), GridSize.X, false);
+}
+
+/**
+ * The inverse of "WriteHeights", reading the original tiles in file order through a single tile buffer.
+ */
+bool FErosionTileCache::ReadOriginalHeights(TArray<float>& OutHeights)
+{
+	OutHeights.SetNumUninitialized(GridSize.X * GridSize.Y);
+
+	TArray<float> TileHeights;
+	TileHeights.SetNumUninitialized(TileSize * TileSize);
+
+	if (!FileHandle->Seek(0))
+	{
+		return false;
+	}
+
+	for (int32 TileY = 0; TileY < TileCount.Y; TileY++)
+	{
+		for (int32 TileX = 0; TileX < TileCount.X; TileX++)
+		{
+			if (!FileHandle->Read(reinterpret_cast<uint8*>(TileHeights.GetData()), TileHeights.Num() * sizeof(float)))
+			{
+				UE_LOG(LogDropByDropErosion, Error, TEXT("Unable to read the erosion tile file \"%s\"!"), *FilePath);
+				return false;
+			}
+
+			const FIntPoint TileMin(TileX * TileSize, TileY * TileSize);
+			const int32 Width = FMath::Min(TileSize, GridSize.X - TileMin.X);
+			const int32 Height = FMath::Min(TileSize, GridSize.Y - TileMin.Y);
+
+			for (int32 Y = 0; Y < Height; Y++)
+			{
+				FMemory::Memcpy(OutHeights.GetData() + (TileMin.Y + Y) * GridSize.X + TileMin.X, TileHeights.GetData() + Y * TileSize, Width * sizeof(float));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FErosionTileCache::ReadRegion(const FIntRect& Region, float* OutHeights, const int32 Stride)
+{
+	return CopyRegion(Region, OutHeights, Stride, false);
+}
+
+bool FErosionTileCache::WriteRegion(const FIntRect& Region, const float* InHeights, const int32 Stride)
+{
+	return CopyRegion(Region, const_cast<float*>(InHeights), Stride, true);
+}
+
+/**
+ * Walks the tiles overlapping the region and copies the overlapping part of each row.
+ * Every tile is used right after being requested, so evictions never invalidate a tile in use.
+ */
+bool FErosionTileCache::CopyRegion(const FIntRect& Region, float* Heights, const int32 Stride, const bool bWrite)
+{
+	const FIntPoint FirstTile(Region.Min.X / TileSize, Region.Min.Y / TileSize);
+	const FIntPoint LastTile((Region.Max.X - 1) / TileSize, (Region.Max.Y - 1) / TileSize);
+
+	for (int32 TileY = FirstTile.Y; TileY <= LastTile.Y; TileY++)
+	{
+		for (int32 TileX = FirstTile.X; TileX <= LastTile.X; TileX++)
+		{
+			float* TileHeights = GetTile(FIntPoint(TileX, TileY), bWrite);
+			if (!TileHeights)
+			{
+				return false;
+			}
+
+			// Part of the region covered by this tile.
+			const FIntPoint TileMin(TileX * TileSize, TileY * TileSize);
+			FIntRect Overlap(TileMin, TileMin + FIntPoint(TileSize, TileSize));
+			Overlap.Clip(Region);
+
+			const SIZE_T RowBytes = Overlap.Width() * sizeof(float);
+
+			for (int32 Y = Overlap.Min.Y; Y < Overlap.Max.Y; Y++)
+			{
+				float* TileRow = TileHeights + (Y - TileMin.Y) * TileSize + (Overlap.Min.X - TileMin.X);
+				float* RegionRow = Heights + static_cast<int64>(Y - Region.Min.Y) * Stride + (Overlap.Min.X - Region.Min.X);
+
+				if (bWrite)
+				{
+					FMemory::Memcpy(TileRow, RegionRow, RowBytes);
+				}
+				else
+				{
+					FMemory::Memcpy(RegionRow, TileRow, RowBytes);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Serves the tile from memory if resident, otherwise reads it into a free slot
+ * or into the slot of the least recently used tile.
+ */
+float* FErosionTileCache::GetTile(const FIntPoint& Coordinates, const bool bWrite)
+{
+	int32 Slot = INDEX_NONE;
+
+	if (const int32* ResidentSlot = ResidentSlots.Find(Coordinates))
+	{
+		Slot = *ResidentSlot;
+		Hits++;
+	}
+	else
+	{
+		Misses++;
+
+		if (ResidentTiles.Num() < MaxResidentTiles)
+		{
+			Slot = ResidentTiles.AddDefaulted();
+			ResidentTiles[Slot].Heights.SetNumUninitialized(TileSize * TileSize);
+		}
+		else
+		{
+			// Evict the least recently used tile.
+			Slot = 0;
+			for (int32 Index = 1; Index < ResidentTiles.Num(); Index++)
+			{
+				if (ResidentTiles[Index].LastUse < ResidentTiles[Slot].LastUse)
+				{
+					Slot = Index;
+				}
+			}
+
+			if (!StoreTile(ResidentTiles[Slot]))
+			{
+				return nullptr;
+			}
+
+			ResidentSlots.Remove(ResidentTiles[Slot].Coordinates);
+		}
+
+		FResidentTile& Tile = ResidentTiles[Slot];
+		Tile.Coordinates = Coordinates;
+		Tile.bDirty = false;
+
+		const bool bModified = StoredTiles[Coordinates.X + Coordinates.Y * TileCount.X];
+
+		if (!FileHandle->Seek(GetTileOffset(Coordinates, bModified)) || !FileHandle->Read(reinterpret_cast<uint8*>(Tile.Heights.GetData()), Tile.Heights.Num() * sizeof(float)))
+		{
+			UE_LOG(LogDropByDropErosion, Error, TEXT("Unable to read the erosion tile file \"%s\"!"), *FilePath);
+
+			// The slot holds no tile, reuse it first.
+			Tile.Coordinates = FIntPoint::NoneValue;
+			Tile.LastUse = 0;
+			return nullptr;
+		}
+
+		ResidentSlots.Add(Coordinates, Slot);
+	}
+
+	FResidentTile& Tile = ResidentTiles[Slot];
+	Tile.LastUse = ++UseClock;
+	Tile.bDirty |= bWrite;
+
+	return Tile.Heights.GetData();
+}
+
+bool FErosionTileCache::StoreTile(FResidentTile& Tile)
+{
+	if (!Tile.bDirty)
+	{
+		return true;
+	}
+
+	if (!FileHandle->Seek(GetTileOffset(Tile.Coordinates, true)) || !FileHandle->Write(reinterpret_cast<const uint8*>(Tile.Heights.GetData()), Tile.Heights.Num() * sizeof(float)))
+	{
+		UE_LOG(LogDropByDropErosion, Error, TEXT("Unable to write the erosion tile file \"%s\"!"), *FilePath);
+		return false;
+	}
+
+	StoredTiles[Tile.Coordinates.X + Tile.Coordinates.Y * TileCount.X] = true;
+	Tile.bDirty = false;
+	return true;
+}
+
+int64 FErosionTileCache::GetTileOffset(const FIntPoint& Coordinates, const bool bModified) const
+{
+	const int64 NumTiles = static_cast<int64>(TileCount.X) * TileCount.Y;
+	const int64 TileIndex = static_cast<int64>(Coordinates.Y) * TileCount.X + Coordinates.X + (bModified ? NumTiles : 0);
+
+	return TileIndex * TileSize * TileSize * sizeof(float);
+}
+
+#pragma endregion
 
 /**
  * Sets the height values in the erosion context.
- * Reserves memory and copies the provided height array.
+ * Copies the provided height array.
  */
 void UErosionLibrary::SetHeights(FErosionContext& ErosionContext, const TArray<float>& InHeights)
 {
-	ErosionContext.GridHeights.Reserve(InHeights.Num());
 	ErosionContext.GridHeights = InHeights;
 }
 
+/**
+ * Sets the height values in the erosion context.
+ * Takes ownership of the provided height array.
+ */
+void UErosionLibrary::SetHeights(FErosionContext& ErosionContext, TArray<float>&& InHeights)
+{
+	ErosionContext.GridHeights = MoveTemp(InHeights);
+}
+
 /**
  * Gets the current height values from the erosion context.
  * Returns a copy of the internal height array.
@@ -25,18 +469,37 @@ TArray<float> UErosionLibrary::GetHeights(const FErosionContext& ErosionContext)
 }
 
 /**
- * Initializes a water drop with starting position, direction, and properties.
- * Position is randomly placed within grid bounds, direction is determined by wind settings.
+ * Gets the current height values from the erosion context.
+ * Returns a view of the internal height array, without copying it.
+ */
+TConstArrayView<float> UErosionLibrary::GetHeightsView(const FErosionContext& ErosionContext)
+{
+	return ErosionContext.GridHeights;
+}
+
+/**
+ * Moves the internal height array out of the erosion context.
+ * The context can be filled again with "SetHeights".
  */
-FDrop& UErosionLibrary::InitDrop(const FErosionSettings& ErosionSettings, FDrop& OutDrop, const int32 GridSize /* GridSize = MapSize / CellSize */)
+TArray<float> UErosionLibrary::TakeHeights(FErosionContext& ErosionContext)
 {
-	const float Limit = static_cast<float>(GridSize - 1);
+	return MoveTemp(ErosionContext.GridHeights);
+}
 
+/**
+ * Initializes a water drop with starting position, direction, and properties.
+ * Position is randomly placed within the spawn bounds, direction is determined by wind settings.
+ */
+template<bool bWindBias, bool bRandomWind>
+FDrop& UErosionLibrary::InitDrop(const FErosionSettings& ErosionSettings, FDrop& OutDrop, const FIntRect& SpawnBounds, const FIntPoint& GridSize /* GridSize = MapSize / CellSize */, FErosionRandomStream& RandomStream)
+{
 	// Random starting position within valid grid bounds.
-	OutDrop.Position = FVector2D(FMath::RandRange(0.f, Limit), FMath::RandRange(0.f, Limit));
+	const float MaxX = FMath::Min(static_cast<float>(SpawnBounds.Max.X), static_cast<float>(GridSize.X - 1));
+	const float MaxY = FMath::Min(static_cast<float>(SpawnBounds.Max.Y), static_cast<float>(GridSize.Y - 1));
+	OutDrop.Position = FVector2f(RandomStream.FRandRange(SpawnBounds.Min.X, MaxX), RandomStream.FRandRange(SpawnBounds.Min.Y, MaxY));
 
 	// Direction based on wind settings.
-	OutDrop.Direction = GetWindDirection(ErosionSettings);
+	OutDrop.Direction = GetWindDirection<bWindBias, bRandomWind>(ErosionSettings, RandomStream);
 
 	// Initial velocity and water amount.
 	OutDrop.Velocity = 1;
@@ -49,481 +512,1899 @@ FDrop& UErosionLibrary::InitDrop(const FErosionSettings& ErosionSettings, FDrop&
  * Computes the gradient vector from four corner height values.
  * Calculates the normalized directional derivative.
  */
-FVector2D UErosionLibrary::ComputeGradient(const float P1, const float P2, const float P3, const float P4)
+FVector2f UErosionLibrary::ComputeGradient(const float P1, const float P2, const float P3, const float P4)
 {
 	// Normalization with safe check to avoid division by zero.
-	return FVector2D(P1 - P2, P3 - P4).GetSafeNormal();
+	return FVector2f(P1 - P2, P3 - P4).GetSafeNormal();
 }
 
 /**
  * Computes gradient using bilinear interpolation of four values.
  * Uses offset position within cell (u, v coordinates in [0-1) range).
  */
-FVector2D UErosionLibrary::ComputeGradientByInterpolate(const FVector2D& OffsetPosition, const float F1, const float F2, const float F3, const float F4)
+FVector2f UErosionLibrary::ComputeGradientByInterpolate(const FVector2f& OffsetPosition, const float F1, const float F2, const float F3, const float F4)
 {
 	// (x, y) = (u, v)
 	// Linear interpolation along both axes.
-	return FVector2D(
+	return FVector2f(
 		F1 * (1 - OffsetPosition.Y) + F2 * OffsetPosition.Y,
 		F3 * (1 - OffsetPosition.X) + F4 * OffsetPosition.X
 	);
 }
 
-/**
- * Retrieves and sets the height values for the four corners of a grid cell.
- * Handles boundary cases where position is at or beyond grid edges.
- */
-FCornersHeights& UErosionLibrary::SetCornersHeights(const FErosionContext& ErosionContext, FCornersHeights& InCornersHeights, const FVector2D& TruncatedPosition, const int32 GridSize)
-{
-	const EOutOfBoundResult OutOfBoundResult = GetOutOfBoundAsResult(TruncatedPosition, GridSize);
-
-	switch (OutOfBoundResult)
-	{
-	case Error_Right_Down:
-		// Both X and Y are out of bounds: use last grid cell height for all corners.
-		InCornersHeights.X_Y = ErosionContext.GridHeights[GridSize * GridSize - 1];
-		InCornersHeights.X1_Y = ErosionContext.GridHeights[GridSize * GridSize - 1];
-		InCornersHeights.X_Y1 = ErosionContext.GridHeights[GridSize * GridSize - 1];
-		InCornersHeights.X1_Y1 = ErosionContext.GridHeights[GridSize * GridSize - 1];
-		break;
-	case Error_Right:
-		// X is out of bounds: clamp X coordinate, use valid Y coordinates.
-		InCornersHeights.X_Y = ErosionContext.GridHeights[TruncatedPosition.X + TruncatedPosition.Y * GridSize];
-		InCornersHeights.X1_Y = ErosionContext.GridHeights[TruncatedPosition.X + TruncatedPosition.Y * GridSize];
-		InCornersHeights.X_Y1 = ErosionContext.GridHeights[(TruncatedPosition.X + GridSize) + TruncatedPosition.Y * GridSize];
-		InCornersHeights.X1_Y1 = ErosionContext.GridHeights[(TruncatedPosition.X + GridSize) + TruncatedPosition.Y * GridSize];
-		break;
-	case Error_Down:
-		// Y is out of bounds: use valid X coordinates, clamp Y coordinate.
-		InCornersHeights.X_Y = ErosionContext.GridHeights[TruncatedPosition.X + TruncatedPosition.Y * GridSize];
-		InCornersHeights.X1_Y = ErosionContext.GridHeights[TruncatedPosition.X + TruncatedPosition.Y * GridSize];
-		InCornersHeights.X_Y1 = ErosionContext.GridHeights[(TruncatedPosition.X + 1) + TruncatedPosition.Y * GridSize];
-		InCornersHeights.X1_Y1 = ErosionContext.GridHeights[(TruncatedPosition.X + 1) + TruncatedPosition.Y * GridSize];
-		break;
-	case No_Error:
-		// All corners are within valid bounds: retrieve normal corner heights.
-		InCornersHeights.X_Y = ErosionContext.GridHeights[TruncatedPosition.X + TruncatedPosition.Y * GridSize];					  // P(x, y)
-		InCornersHeights.X1_Y = ErosionContext.GridHeights[(TruncatedPosition.X + 1) + TruncatedPosition.Y * GridSize];			  // P(x + 1, y)
-		InCornersHeights.X_Y1 = ErosionContext.GridHeights[(TruncatedPosition.X + GridSize) + TruncatedPosition.Y * GridSize];		  // P(x, y + 1)
-		InCornersHeights.X1_Y1 = ErosionContext.GridHeights[(TruncatedPosition.X + GridSize + 1) + TruncatedPosition.Y * GridSize];   // P(x + 1, y + 1)
-		break;
-	}
+/**
+ * Retrieves and sets the height values for the four corners of a grid cell.
+ * The apron of the padded grid makes the right and bottom neighbours of border cells
+ * always readable, so no boundary case has to be handled.
+ */
+FCornersHeights& UErosionLibrary::SetCornersHeights(const TArray<float>& GridHeights, FCornersHeights& InCornersHeights, const FIntPoint& TruncatedPosition, const FErosionGrid& Grid)
+{
+	int32 X_Y, X1_Y, X_Y1, X1_Y1;
+	Grid.GetCornerIndices(TruncatedPosition.X, TruncatedPosition.Y, X_Y, X1_Y, X_Y1, X1_Y1);
+
+	InCornersHeights.X_Y = GridHeights[X_Y];		// P(x, y)
+	InCornersHeights.X1_Y = GridHeights[X1_Y];		// P(x + 1, y)
+	InCornersHeights.X_Y1 = GridHeights[X_Y1];		// P(x, y + 1)
+	InCornersHeights.X1_Y1 = GridHeights[X1_Y1];	// P(x + 1, y + 1)
+
+	return InCornersHeights;
+}
+
+/**
+ * Performs bilinear interpolation using corner heights and offset position.
+ * Standard bilinear interpolation formula for smooth height calculation within a cell.
+ */
+float UErosionLibrary::GetBilinearInterpolation(const FVector2f& OffsetPosition, const FCornersHeights& CornersHeights)
+{
+	return CornersHeights.X_Y * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y) +
+		CornersHeights.X1_Y * OffsetPosition.X * (1 - OffsetPosition.Y) +
+		CornersHeights.X_Y1 * (1 - OffsetPosition.X) * OffsetPosition.Y +
+		CornersHeights.X1_Y1 * OffsetPosition.X * OffsetPosition.Y;
+}
+
+/**
+ * Builds the brush of the given radius once, so drops only have to walk a table on every step.
+ * Scans a square area centered on the drop cell with side length = 2 * radius + 1
+ * (radius = 1 -> 9 points, radius = 2 -> 25 points...) and keeps the cells with a positive weight.
+ * Weights are measured from the drop cell, so they do not depend on the position inside the cell.
+ */
+void UErosionLibrary::BuildErosionBrush(FErosionBrush& Brush, const int32 Radius, const int32 Stride)
+{
+	const int32 SampledPointsInRadius = (2 * Radius + 1) * (2 * Radius + 1);
+	const int32 SquaredErosionRadius = Radius * Radius;
+
+	Brush.Radius = Radius;
+	Brush.Stride = Stride;
+	Brush.Offsets.Reset(SampledPointsInRadius);
+	Brush.IndexOffsets.Reset(SampledPointsInRadius);
+	Brush.Weights.Reset(SampledPointsInRadius);
+
+	float WeightsSum = 0;
+
+	for (int32 Y = -Radius; Y <= Radius; Y++)
+	{
+		for (int32 X = -Radius; X <= Radius; X++)
+		{
+			// Weight = max(0, radius^2 - distance^2)
+			const int32 Weight = SquaredErosionRadius - (X * X + Y * Y);
+			if (Weight <= 0)
+			{
+				continue;
+			}
+
+			Brush.Offsets.Add(FIntPoint(X, Y));
+			Brush.IndexOffsets.Add(X + Y * Stride);
+			Brush.Weights.Add(static_cast<float>(Weight));
+			WeightsSum += Weight;
+		}
+	}
+
+	// A zero radius erodes the drop cell only.
+	if (Brush.Offsets.IsEmpty())
+	{
+		Brush.Offsets.Add(FIntPoint::ZeroValue);
+		Brush.IndexOffsets.Add(0);
+		Brush.Weights.Add(1.f);
+		return;
+	}
+
+	// Normalize weights so they sum to "1.0".
+	for (float& Weight : Brush.Weights)
+	{
+		Weight /= WeightsSum;
+	}
+}
+
+/**
+ * Pre-allocates the workspace for the largest set of points a drop step can touch,
+ * and for the stratified spawn cells of the largest spawn bounds (tiles never exceed their full size).
+ * After this call, simulating drops with the given brush never reallocates the workspace.
+ */
+void UErosionLibrary::ReserveWorkspace(FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FIntPoint& MaxSpawnSize)
+{
+	Workspace.SquaredWeights.Reserve(Brush.Offsets.Num());
+	Workspace.Points.Reserve(Brush.Offsets.Num());
+
+	const int32 MaxStrata = FMath::Max(FMath::DivideAndRoundUp(MaxSpawnSize.X, STRATIFIED_SPAWN_CELL_SIZE), 1) * FMath::Max(FMath::DivideAndRoundUp(MaxSpawnSize.Y, STRATIFIED_SPAWN_CELL_SIZE), 1);
+	Workspace.SpawnStrata.Reserve(MaxStrata);
+}
+
+/**
+ * Distributes sediment deposit across nearby grid points using bilinear interpolation.
+ * Deposits past the right and bottom edges land in the apron and are discarded when stitching.
+ */
+void UErosionLibrary::ComputeDepositOnPoints(TArray<float>& GridHeights, const FIntPoint& IntegerPosition, const FVector2f& OffsetPosition, const float Deposit, const FErosionGrid& Grid)
+{
+	int32 X_Y, X1_Y, X_Y1, X1_Y1;
+	Grid.GetCornerIndices(IntegerPosition.X, IntegerPosition.Y, X_Y, X1_Y, X_Y1, X1_Y1);
+
+	GridHeights[X_Y] += Deposit * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y);	// P(x, y)
+	GridHeights[X1_Y] += Deposit * OffsetPosition.X * (1 - OffsetPosition.Y);		// P(x + 1, y)
+	GridHeights[X_Y1] += Deposit * (1 - OffsetPosition.X) * OffsetPosition.Y;		// P(x, y + 1)
+	GridHeights[X1_Y1] += Deposit * OffsetPosition.X * OffsetPosition.Y;			// P(x + 1, y + 1)
+}
+
+/**
+ * Checks if a position is outside the given region of the grid.
+ * Returns true if any coordinate is below the region minimum or reaches its maximum.
+ */
+bool UErosionLibrary::IsOutOfBound(const FVector2f& DropPosition, const FIntRect& Bounds)
+{
+	return DropPosition.X < Bounds.Min.X || DropPosition.X >= Bounds.Max.X || DropPosition.Y < Bounds.Min.Y || DropPosition.Y >= Bounds.Max.Y;
+}
+
+/**
+ * Calculates wind direction vector from erosion settings.
+ * Uses "Box-Muller" algorithm for "Gaussian distribution" if wind bias is enabled.
+ * Direction can be cardinal, diagonal, or random with optional bias variation.
+ */
+template<bool bWindBias, bool bRandomWind>
+FVector2f UErosionLibrary::GetWindDirection(const FErosionSettings& ErosionSettings, FErosionRandomStream& RandomStream)
+{
+	const float MinAngle = 0.f;
+	const float MaxAngle = 360.f;
+	const float Sigma = 35.f;  // Standard deviation for "Gaussian distribution".
+	float Mu = 0.f;  // Mean angle.
+
+	// Top-Left Pivot coordinate system.
+	// Determine base wind angle from cardinal/diagonal direction.
+	if constexpr (bRandomWind)
+	{
+		Mu = RandomStream.FRandRange(MinAngle, MaxAngle);
+	}
+	else
+	{
+		TryGetWindMeanAngleDegrees(ErosionSettings, Mu);
+	}
+
+	float FinalAngle = Mu;
+
+	// Apply Gaussian bias to wind direction if enabled.
+	if constexpr (bWindBias)
+	{
+		// "Box-Muller" algorithm for Gaussian random number generation.
+		const float First = RandomStream.FRandRange(0.f + KINDA_SMALL_NUMBER, 1.f);
+		const float Second = RandomStream.FRandRange(0.f + KINDA_SMALL_NUMBER, 1.f);
+		const float Z = FMath::Sqrt(-2.f * FMath::Loge(First)) * FMath::Cos(2.f * PI * Second);
+
+		// Apply "Gaussian distribution" with mean Mu and standard deviation Sigma.
+		FinalAngle = Mu + (Sigma * Z);
+
+		// Wrap angle to [0, 360) range.
+		while (FinalAngle < MinAngle)
+		{
+			FinalAngle += MaxAngle;
+		}
+
+		while (FinalAngle >= MaxAngle)
+		{
+			FinalAngle -= MaxAngle;
+		}
+	}
+
+	// Convert angle to radians and create direction vector.
+	const float Rad = FMath::DegreesToRadians(FinalAngle);
+	const float Strength = RandomStream.FRandRange(0.f, 1.f);  // Random strength multiplier.
+
+	return FVector2f(FMath::Cos(Rad), FMath::Sin(Rad)) * Strength;
+}
+
+/**
+ * Attempts to get the normalized mean wind angle from erosion settings.
+ * Returns false for random wind direction, true otherwise with normalized angle in [0, 360) range.
+ */
+bool UErosionLibrary::TryGetWindMeanAngleDegrees(const FErosionSettings& ErosionSettings, float& MeanAngle)
+{
+	float Mu = 0.f;
+
+	// Map wind direction enum to angle in degrees.
+	switch (ErosionSettings.WindDirection)
+	{
+		case EWindDirection::East:         Mu = 0.f;   break;
+		case EWindDirection::South_East:   Mu = 45.f;  break;
+		case EWindDirection::South:        Mu = 90.f;  break;
+		case EWindDirection::South_West:   Mu = 135.f; break;
+		case EWindDirection::West:         Mu = 180.f; break;
+		case EWindDirection::North_West:   Mu = 225.f; break;
+		case EWindDirection::North:        Mu = 270.f; break;
+		case EWindDirection::North_East:   Mu = 315.f; break;
+		case EWindDirection::Random:
+		default: return false;  // Cannot provide mean for random direction.
+	}
+
+	// Normalize angle to [0, 360) range.
+	float Angle = FMath::Fmod(Mu, 360.f);
+	MeanAngle = (Angle < 0.f) ? (Angle + 360.f) : Angle;
+
+	return true;
+}
+
+/**
+ * Converts a wind angle in degrees to a normalized unit direction vector.
+ * Uses standard trigonometric conversion with safe normalization.
+ */
+FVector2D UErosionLibrary::GetWindUnitVectorFromAngle(const float Degrees)
+{
+	const float Rad = FMath::DegreesToRadians(Degrees);
+
+	const float X = FMath::Cos(Rad);
+	const float Y = FMath::Sin(Rad);
+
+	return FVector2D(X, Y).GetSafeNormal();
+}
+
+/**
+ * Applies erosion effects for a single water drop simulation.
+ * Simulates drop movement, sediment transport, erosion and deposition over multiple cycles.
+ * Uses particle-based hydraulic erosion algorithm.
+ */
+template<int32 Radius>
+void UErosionLibrary::ApplyErosion(TArray<float>& GridHeights, FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FErosionSettings& ErosionSettings, FDrop& Drop, const FErosionGrid& Grid, const FIntRect& DropBounds)
+{
+	float Sediment = 0;  // Amount of sediment currently carried by the drop.
+
+	// Simulate drop movement for specified number of cycles.
+	for (int64 Cycle = 0; Cycle < ErosionSettings.MaxPath; Cycle++)
+	{
+		// 0) Check if drop has left the valid grid area.
+		if (IsOutOfBound(Drop.Position, DropBounds))
+		{
+			return;
+		}
+
+		// Calculate integer and fractional parts of drop position.
+		const FIntPoint TruncatedPosOld = FIntPoint(FMath::FloorToInt32(Drop.Position.X), FMath::FloorToInt32(Drop.Position.Y)); // (x, y)
+		const FVector2f OffsetPosOld = FVector2f(Drop.Position.X - TruncatedPosOld.X, Drop.Position.Y - TruncatedPosOld.Y);
+
+		// 1) Get heights at all four corners of the current cell.
+		FCornersHeights PosOldHeights;
+		SetCornersHeights(GridHeights, PosOldHeights, TruncatedPosOld, Grid);
+
+		// 2) Compute gradient at current position using bilinear interpolation.
+		FVector2f DropGradient = ComputeGradientByInterpolate(
+			OffsetPosOld,
+			PosOldHeights.X1_Y - PosOldHeights.X_Y,
+			PosOldHeights.X1_Y1 - PosOldHeights.X_Y1,
+			PosOldHeights.X_Y1 - PosOldHeights.X_Y,
+			PosOldHeights.X1_Y1 - PosOldHeights.X1_Y
+		);
+
+		// 3) Update direction using inertia blending.
+		// Mix previous direction (inertia) with downhill gradient.
+		Drop.Direction = Drop.Direction * ErosionSettings.Inertia - DropGradient * (1 - ErosionSettings.Inertia);
+
+		// Stop simulation if direction becomes invalid.
+		if (Drop.Direction.SquaredLength() <= 0)
+		{
+			return;
+		}
+
+		Drop.Direction.Normalize();
+
+		// 4) Calculate new position by moving in current direction.
+		Drop.Position = Drop.Position + Drop.Direction;
+
+		// Check if new position is still valid.
+		if (IsOutOfBound(Drop.Position, DropBounds))
+		{
+			return;
+		}
+
+		// Initialize weights for points within erosion radius.
+		InitWeights<Radius>(Workspace, Brush, Drop.Position, Grid);
+
+		// 5) Calculate height difference between old and new positions.
+		const float HeightPosOld = GetBilinearInterpolation(OffsetPosOld, PosOldHeights);
+
+		const FIntPoint TruncatedPosNew = FIntPoint(FMath::FloorToInt32(Drop.Position.X), FMath::FloorToInt32(Drop.Position.Y));
+		const FVector2f OffsetPosNew = FVector2f(Drop.Position.X - TruncatedPosNew.X, Drop.Position.Y - TruncatedPosNew.Y);
+
+		FCornersHeights PosNewHeights;
+		SetCornersHeights(GridHeights, PosNewHeights, TruncatedPosNew, Grid);
+
+		const float HeightPosNew = GetBilinearInterpolation(OffsetPosNew, PosNewHeights);
+		const float HeightsDifference = HeightPosNew - HeightPosOld;
+
+		// 6) Determine whether to deposit or erode sediment.
+
+		// Calculate sediment carrying capacity based on slope, velocity, and water.
+		const float C = FMath::Max(-HeightsDifference, ErosionSettings.MinimalSlope) * Drop.Velocity * Drop.Water * ErosionSettings.Capacity;
+
+		const bool bDropHasMovingUp = HeightsDifference > 0;
+		const bool bDropHasToDeposit = Sediment > C;
+
+		// Deposit sediment if moving uphill or carrying too much.
+		if (bDropHasMovingUp || bDropHasToDeposit)
+		{
+			// Calculate deposit amount.
+			float Deposit = bDropHasMovingUp ? FMath::Min(HeightsDifference, Sediment) : (Sediment - C) * ErosionSettings.DepositionSpeed;
+			Sediment -= Deposit;
+
+			// Distribute deposit across nearby cells.
+			ComputeDepositOnPoints(GridHeights, TruncatedPosOld, OffsetPosOld, Deposit, Grid);
+			Workspace.HeightChange += Deposit;
+		}
+		else
+		{
+			// Erode terrain and pick up sediment.
+			float Erosion = FMath::Min((C - Sediment) * ErosionSettings.ErosionSpeed, -HeightsDifference);
+			const float SedimentBeforeErosion = Sediment;
+
+			// Apply erosion to all points within radius, proportionally to their weight.
+			for (int32 Index = 0; Index < Workspace.Points.Num(); Index++)
+			{
+				const int32 MapIndex = Workspace.Points[Index];
+				const float ErosionValue = Workspace.SquaredWeights[Index] * Erosion;
+
+				// Ensure we don't erode below zero height.
+				const float DeltaSediment = GridHeights[MapIndex] < ErosionValue ? GridHeights[MapIndex] : ErosionValue;
+
+				GridHeights[MapIndex] -= DeltaSediment;
+				Sediment += DeltaSediment;
+			}
+
+			Workspace.HeightChange += Sediment - SedimentBeforeErosion;
+		}
+
+		// 7) Update drop's physical properties.
+		// Calculate new velocity.
+		const float Velocity = ((Drop.Velocity * Drop.Velocity) + (-HeightsDifference) * ErosionSettings.Gravity);
+		Drop.Velocity = Velocity > 0 ? FMath::Sqrt(Velocity) : 0;
+
+		// Simulate water evaporation.
+		Drop.Water = Drop.Water * (1 - ErosionSettings.Evaporation);
+	}
+}
+
+/**
+ * Vectorized version of "ApplyErosion", advancing "FDropBatch::NumLanes" drops in lockstep.
+ * Position, gradient, direction, height, capacity, velocity and evaporation updates run on SIMD registers;
+ * drops that stop are masked out and keep their state. Corner fetches, deposits and brush writes stay scalar.
+ * The corners of all the lanes are gathered at once, before any lane writes: within a step, a lane's height
+ * difference and capacity ignore what the lanes before it deposited or eroded (their writes show from the next step).
+ * Deposits and brush writes are then applied lane by lane on the current heights, so the erosion never digs below zero.
+ */
+template<int32 Radius>
+void UErosionLibrary::ApplyErosionBatch(TArray<float>& GridHeights, FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FErosionSettings& ErosionSettings, FDropBatch& Batch, const FErosionGrid& Grid, const FIntRect& DropBounds)
+{
+	constexpr int32 NumLanes = FDropBatch::NumLanes;
+	static_assert(NumLanes == 4, "The vectorized erosion kernel works on 4-wide float registers.");
+
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float Inertia = VectorSetFloat1(ErosionSettings.Inertia);
+	const VectorRegister4Float GradientWeight = VectorSetFloat1(1.f - ErosionSettings.Inertia);
+	const VectorRegister4Float MinimalSlope = VectorSetFloat1(ErosionSettings.MinimalSlope);
+	const VectorRegister4Float Capacity = VectorSetFloat1(static_cast<float>(ErosionSettings.Capacity));
+	const VectorRegister4Float Gravity = VectorSetFloat1(static_cast<float>(ErosionSettings.Gravity));
+	const VectorRegister4Float Retention = VectorSetFloat1(1.f - ErosionSettings.Evaporation);
+
+	const VectorRegister4Float MinX = VectorSetFloat1(static_cast<float>(DropBounds.Min.X));
+	const VectorRegister4Float MinY = VectorSetFloat1(static_cast<float>(DropBounds.Min.Y));
+	const VectorRegister4Float MaxX = VectorSetFloat1(static_cast<float>(DropBounds.Max.X));
+	const VectorRegister4Float MaxY = VectorSetFloat1(static_cast<float>(DropBounds.Max.Y));
+
+	// Lane-wise mask of the positions inside the drop bounds.
+	auto IsInBound = [&](const VectorRegister4Float& X, const VectorRegister4Float& Y)
+		{
+			return VectorBitwiseAnd(
+				VectorBitwiseAnd(VectorCompareGE(X, MinX), VectorCompareLT(X, MaxX)),
+				VectorBitwiseAnd(VectorCompareGE(Y, MinY), VectorCompareLT(Y, MaxY)));
+		};
+
+	// Lane-wise bilinear interpolation of the four corner heights.
+	auto Bilinear = [&](const VectorRegister4Float* Corners, const VectorRegister4Float& U, const VectorRegister4Float& V)
+		{
+			const VectorRegister4Float OneMinusU = VectorSubtract(One, U);
+			const VectorRegister4Float OneMinusV = VectorSubtract(One, V);
+
+			VectorRegister4Float Height = VectorMultiply(Corners[0], VectorMultiply(OneMinusU, OneMinusV));
+			Height = VectorMultiplyAdd(Corners[1], VectorMultiply(U, OneMinusV), Height);
+			Height = VectorMultiplyAdd(Corners[2], VectorMultiply(OneMinusU, V), Height);
+			return VectorMultiplyAdd(Corners[3], VectorMultiply(U, V), Height);
+		};
+
+	// Scalar gather of the corner heights of each alive lane (dead lanes read zero).
+	alignas(16) float CornerLanes[4][NumLanes];
+	alignas(16) float CellXLanes[NumLanes];
+	alignas(16) float CellYLanes[NumLanes];
+
+	auto GatherCorners = [&](const VectorRegister4Float& CellX, const VectorRegister4Float& CellY, const int32 AliveBits, VectorRegister4Float* OutCorners)
+		{
+			VectorStoreAligned(CellX, CellXLanes);
+			VectorStoreAligned(CellY, CellYLanes);
+
+			for (int32 Lane = 0; Lane < NumLanes; Lane++)
+			{
+				FCornersHeights Corners = { 0.f, 0.f, 0.f, 0.f };
+				if (AliveBits & (1 << Lane))
+				{
+					SetCornersHeights(GridHeights, Corners, FIntPoint(static_cast<int32>(CellXLanes[Lane]), static_cast<int32>(CellYLanes[Lane])), Grid);
+				}
+
+				CornerLanes[0][Lane] = Corners.X_Y;
+				CornerLanes[1][Lane] = Corners.X1_Y;
+				CornerLanes[2][Lane] = Corners.X_Y1;
+				CornerLanes[3][Lane] = Corners.X1_Y1;
+			}
+
+			for (int32 Corner = 0; Corner < 4; Corner++)
+			{
+				OutCorners[Corner] = VectorLoadAligned(CornerLanes[Corner]);
+			}
+		};
+
+	VectorRegister4Float PositionX = VectorLoadAligned(Batch.PositionX);
+	VectorRegister4Float PositionY = VectorLoadAligned(Batch.PositionY);
+	VectorRegister4Float DirectionX = VectorLoadAligned(Batch.DirectionX);
+	VectorRegister4Float DirectionY = VectorLoadAligned(Batch.DirectionY);
+	VectorRegister4Float Velocity = VectorLoadAligned(Batch.Velocity);
+	VectorRegister4Float Water = VectorLoadAligned(Batch.Water);
+	VectorRegister4Float Alive = MakeVectorRegister(
+		Batch.bAlive[0] ? 0xFFFFFFFFu : 0u, Batch.bAlive[1] ? 0xFFFFFFFFu : 0u,
+		Batch.bAlive[2] ? 0xFFFFFFFFu : 0u, Batch.bAlive[3] ? 0xFFFFFFFFu : 0u);
+
+	// Amount of sediment currently carried by each drop.
+	alignas(16) float Sediment[NumLanes] = { 0.f, 0.f, 0.f, 0.f };
+
+	alignas(16) float OffsetXLanes[NumLanes];
+	alignas(16) float OffsetYLanes[NumLanes];
+	alignas(16) float NewPositionXLanes[NumLanes];
+	alignas(16) float NewPositionYLanes[NumLanes];
+	alignas(16) float DifferenceLanes[NumLanes];
+	alignas(16) float CapacityLanes[NumLanes];
+
+	for (int64 Cycle = 0; Cycle < ErosionSettings.MaxPath; Cycle++)
+	{
+		// 0) Mask out drops that left the valid grid area.
+		Alive = VectorBitwiseAnd(Alive, IsInBound(PositionX, PositionY));
+		if (VectorMaskBits(Alive) == 0)
+		{
+			return;
+		}
+
+		// Calculate integer and fractional parts of drop positions.
+		const VectorRegister4Float CellOldX = VectorFloor(PositionX);
+		const VectorRegister4Float CellOldY = VectorFloor(PositionY);
+		const VectorRegister4Float OffsetOldX = VectorSubtract(PositionX, CellOldX);
+		const VectorRegister4Float OffsetOldY = VectorSubtract(PositionY, CellOldY);
+
+		// 1) Get heights at all four corners of the current cells.
+		VectorRegister4Float OldCorners[4];
+		GatherCorners(CellOldX, CellOldY, VectorMaskBits(Alive), OldCorners);
+
+		// Old cells are needed by the deposits, after the next gather overwrites the lanes.
+		alignas(16) float CellOldXLanes[NumLanes];
+		alignas(16) float CellOldYLanes[NumLanes];
+		VectorStoreAligned(CellOldX, CellOldXLanes);
+		VectorStoreAligned(CellOldY, CellOldYLanes);
+
+		// 2) Compute gradients at current positions using bilinear interpolation.
+		const VectorRegister4Float GradientX = VectorMultiplyAdd(
+			VectorSubtract(OldCorners[1], OldCorners[0]), VectorSubtract(One, OffsetOldY),
+			VectorMultiply(VectorSubtract(OldCorners[3], OldCorners[2]), OffsetOldY));
+		const VectorRegister4Float GradientY = VectorMultiplyAdd(
+			VectorSubtract(OldCorners[2], OldCorners[0]), VectorSubtract(One, OffsetOldX),
+			VectorMultiply(VectorSubtract(OldCorners[3], OldCorners[1]), OffsetOldX));
+
+		// 3) Update directions using inertia blending; drops without a direction stop.
+		VectorRegister4Float NewDirectionX = VectorSubtract(VectorMultiply(DirectionX, Inertia), VectorMultiply(GradientX, GradientWeight));
+		VectorRegister4Float NewDirectionY = VectorSubtract(VectorMultiply(DirectionY, Inertia), VectorMultiply(GradientY, GradientWeight));
+
+		const VectorRegister4Float SquaredLength = VectorMultiplyAdd(NewDirectionX, NewDirectionX, VectorMultiply(NewDirectionY, NewDirectionY));
+		Alive = VectorBitwiseAnd(Alive, VectorCompareGT(SquaredLength, Zero));
+
+		const VectorRegister4Float Length = VectorSelect(Alive, VectorSqrt(SquaredLength), One);
+		DirectionX = VectorSelect(Alive, VectorDivide(NewDirectionX, Length), DirectionX);
+		DirectionY = VectorSelect(Alive, VectorDivide(NewDirectionY, Length), DirectionY);
+
+		// 4) Calculate new positions, masking out drops that left the valid grid area.
+		PositionX = VectorSelect(Alive, VectorAdd(PositionX, DirectionX), PositionX);
+		PositionY = VectorSelect(Alive, VectorAdd(PositionY, DirectionY), PositionY);
+
+		Alive = VectorBitwiseAnd(Alive, IsInBound(PositionX, PositionY));
+		const int32 AliveBits = VectorMaskBits(Alive);
+		if (AliveBits == 0)
+		{
+			return;
+		}
+
+		// 5) Calculate height differences between old and new positions.
+		const VectorRegister4Float CellNewX = VectorFloor(PositionX);
+		const VectorRegister4Float CellNewY = VectorFloor(PositionY);
+
+		// Gathered before the writes of this step, shared by all the lanes.
+		VectorRegister4Float NewCorners[4];
+		GatherCorners(CellNewX, CellNewY, AliveBits, NewCorners);
+
+		const VectorRegister4Float HeightOld = Bilinear(OldCorners, OffsetOldX, OffsetOldY);
+		const VectorRegister4Float HeightNew = Bilinear(NewCorners, VectorSubtract(PositionX, CellNewX), VectorSubtract(PositionY, CellNewY));
+		const VectorRegister4Float HeightsDifference = VectorSubtract(HeightNew, HeightOld);
+
+		// 6) Sediment carrying capacity based on slope, velocity, and water.
+		const VectorRegister4Float C = VectorMultiply(VectorMultiply(VectorMax(VectorNegate(HeightsDifference), MinimalSlope), VectorMultiply(Velocity, Water)), Capacity);
+
+		VectorStoreAligned(OffsetOldX, OffsetXLanes);
+		VectorStoreAligned(OffsetOldY, OffsetYLanes);
+		VectorStoreAligned(PositionX, NewPositionXLanes);
+		VectorStoreAligned(PositionY, NewPositionYLanes);
+		VectorStoreAligned(HeightsDifference, DifferenceLanes);
+		VectorStoreAligned(C, CapacityLanes);
+
+		// Deposit or erode lane by lane: these writes scatter on the heightmap.
+		for (int32 Lane = 0; Lane < NumLanes; Lane++)
+		{
+			if (!(AliveBits & (1 << Lane)))
+			{
+				continue;
+			}
+
+			const float Difference = DifferenceLanes[Lane];
+			const bool bDropHasMovingUp = Difference > 0;
+			const bool bDropHasToDeposit = Sediment[Lane] > CapacityLanes[Lane];
+
+			if (bDropHasMovingUp || bDropHasToDeposit)
+			{
+				const float Deposit = bDropHasMovingUp ? FMath::Min(Difference, Sediment[Lane]) : (Sediment[Lane] - CapacityLanes[Lane]) * ErosionSettings.DepositionSpeed;
+				Sediment[Lane] -= Deposit;
+
+				const FIntPoint CellOld(static_cast<int32>(CellOldXLanes[Lane]), static_cast<int32>(CellOldYLanes[Lane]));
+				ComputeDepositOnPoints(GridHeights, CellOld, FVector2f(OffsetXLanes[Lane], OffsetYLanes[Lane]), Deposit, Grid);
+				Workspace.HeightChange += Deposit;
+			}
+			else
+			{
+				const float Erosion = FMath::Min((CapacityLanes[Lane] - Sediment[Lane]) * ErosionSettings.ErosionSpeed, -Difference);
+				const float SedimentBeforeErosion = Sediment[Lane];
+
+				InitWeights<Radius>(Workspace, Brush, FVector2f(NewPositionXLanes[Lane], NewPositionYLanes[Lane]), Grid);
+
+				for (int32 Index = 0; Index < Workspace.Points.Num(); Index++)
+				{
+					const int32 MapIndex = Workspace.Points[Index];
+					const float ErosionValue = Workspace.SquaredWeights[Index] * Erosion;
+
+					// Ensure we don't erode below zero height.
+					const float DeltaSediment = GridHeights[MapIndex] < ErosionValue ? GridHeights[MapIndex] : ErosionValue;
+
+					GridHeights[MapIndex] -= DeltaSediment;
+					Sediment[Lane] += DeltaSediment;
+				}
+
+				Workspace.HeightChange += Sediment[Lane] - SedimentBeforeErosion;
+			}
+		}
+
+		// 7) Update drops' physical properties.
+		const VectorRegister4Float SquaredVelocity = VectorMultiplyAdd(VectorNegate(HeightsDifference), Gravity, VectorMultiply(Velocity, Velocity));
+		Velocity = VectorSelect(Alive, VectorSqrt(VectorMax(SquaredVelocity, Zero)), Velocity);
+		Water = VectorSelect(Alive, VectorMultiply(Water, Retention), Water);
+	}
+}
+
+/**
+ * Initializes weight values for cells within the erosion radius of the drop.
+ * Far from the borders the precomputed brush is copied as it is; brushes clipped
+ * by the grid borders are re-normalized over the cells that are left.
+ * On a blocked grid the index offsets only hold while the brush stays inside the drop's block,
+ * otherwise the index of every cell is computed from its coordinates.
+ */
+template<int32 Radius>
+void UErosionLibrary::InitWeights(FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FVector2f& DropPosition, const FErosionGrid& Grid)
+{
+	// Clear previous weights and points (keeping their memory, see "ReserveWorkspace").
+	checkSlow(Workspace.Points.Max() >= Brush.Offsets.Num() && Workspace.SquaredWeights.Max() >= Brush.Offsets.Num());
+	Workspace.SquaredWeights.Reset();
+	Workspace.Points.Reset();
+
+	// Compile-time radius and brush size, unless this is the generic version.
+	constexpr bool bGenericRadius = Radius < 0;
+	const int32 BrushRadius = bGenericRadius ? Brush.Radius : Radius;
+	const int32 BrushSize = bGenericRadius ? Brush.IndexOffsets.Num() : GetErosionBrushSize(Radius);
+	checkSlow(BrushRadius == Brush.Radius && BrushSize == Brush.IndexOffsets.Num());
+
+	const FIntPoint DropCell(FMath::FloorToInt32(DropPosition.X), FMath::FloorToInt32(DropPosition.Y));
+	const int32 DropIndex = Grid.GetIndex(DropCell.X, DropCell.Y);
+
+	// Interior cell: plain table walk.
+	if (DropCell.X - BrushRadius >= 0 && DropCell.Y - BrushRadius >= 0 && DropCell.X + BrushRadius < Grid.Size.X && DropCell.Y + BrushRadius < Grid.Size.Y)
+	{
+		Workspace.Points.SetNumUninitialized(BrushSize, EAllowShrinking::No);
+		Workspace.SquaredWeights.SetNumUninitialized(BrushSize, EAllowShrinking::No);
+
+		int32* RESTRICT Points = Workspace.Points.GetData();
+		float* RESTRICT Weights = Workspace.SquaredWeights.GetData();
+		const float* RESTRICT BrushWeights = Brush.Weights.GetData();
+
+		if (Grid.IsInsideBlock(DropCell.X, DropCell.Y, BrushRadius))
+		{
+			const int32* RESTRICT IndexOffsets = Brush.IndexOffsets.GetData();
+
+			for (int32 Index = 0; Index < BrushSize; Index++)
+			{
+				Points[Index] = DropIndex + IndexOffsets[Index];
+				Weights[Index] = BrushWeights[Index];
+			}
+		}
+		else
+		{
+			// Brush spanning several blocks.
+			const FIntPoint* RESTRICT Offsets = Brush.Offsets.GetData();
+
+			for (int32 Index = 0; Index < BrushSize; Index++)
+			{
+				Points[Index] = Grid.GetIndex(DropCell.X + Offsets[Index].X, DropCell.Y + Offsets[Index].Y);
+				Weights[Index] = BrushWeights[Index];
+			}
+		}
+
+		return;
+	}
+
+	// Border cell: skip points outside valid grid bounds and re-normalize.
+	float WeightsSum = 0;
+
+	for (int32 Index = 0; Index < Brush.Offsets.Num(); Index++)
+	{
+		const FIntPoint Point = DropCell + Brush.Offsets[Index];
+		if (Point.X < 0 || Point.Y < 0 || Point.X >= Grid.Size.X || Point.Y >= Grid.Size.Y)
+		{
+			continue;
+		}
+
+		Workspace.Points.Add(Grid.GetIndex(Point.X, Point.Y));
+		Workspace.SquaredWeights.Add(Brush.Weights[Index]);
+		WeightsSum += Brush.Weights[Index];
+	}
+
+	for (float& Weight : Workspace.SquaredWeights)
+	{
+		Weight /= WeightsSum;
+	}
+}
+
+/**
+ * Copies the heights into the padded grid used by the simulation.
+ * The apron replicates the nearest border heights, so reading past the right and bottom edges
+ * behaves like clamping the coordinates to the last row or column.
+ * A blocked grid is rounded up to whole blocks and converted cell by cell, once per simulation.
+ */
+void UErosionLibrary::BuildPaddedGrid(FErosionContext& ErosionContext, const FIntPoint& GridSize, const int32 Padding, const int32 BlockShift)
+{
+	FErosionGrid& Grid = ErosionContext.Grid;
+	Grid.Size = GridSize;
+	Grid.Padding = Padding;
+	Grid.Stride = GridSize.X + 2 * Padding;
+	Grid.BlockShift = BlockShift;
+
+	const int32 PaddedRows = GridSize.Y + 2 * Padding;
+
+	if (BlockShift > 0)
+	{
+		// Cells of the last blocks past the padded grid are never read.
+		const int32 BlockSize = 1 << BlockShift;
+		Grid.BlocksPerRow = FMath::DivideAndRoundUp(Grid.Stride, BlockSize);
+		ErosionContext.PaddedHeights.SetNumUninitialized(Grid.BlocksPerRow * FMath::DivideAndRoundUp(PaddedRows, BlockSize) * BlockSize * BlockSize);
+	}
+	else
+	{
+		Grid.BlocksPerRow = 0;
+		ErosionContext.PaddedHeights.SetNumUninitialized(Grid.Stride * PaddedRows);
+	}
+
+	for (int32 Y = 0; Y < PaddedRows; Y++)
+	{
+		const int32 SourceY = FMath::Clamp(Y - Padding, 0, GridSize.Y - 1);
+		const float* SourceRow = ErosionContext.GridHeights.GetData() + SourceY * GridSize.X;
+
+		if (BlockShift > 0)
+		{
+			for (int32 X = 0; X < Grid.Stride; X++)
+			{
+				ErosionContext.PaddedHeights[Grid.GetIndex(X - Padding, Y - Padding)] = SourceRow[FMath::Clamp(X - Padding, 0, GridSize.X - 1)];
+			}
+
+			continue;
+		}
+
+		float* PaddedRow = ErosionContext.PaddedHeights.GetData() + Y * Grid.Stride;
+
+		// Left apron, working row, right apron.
+		for (int32 X = 0; X < Padding; X++)
+		{
+			PaddedRow[X] = SourceRow[0];
+			PaddedRow[Padding + GridSize.X + X] = SourceRow[GridSize.X - 1];
+		}
+
+		FMemory::Memcpy(PaddedRow + Padding, SourceRow, GridSize.X * sizeof(float));
+	}
+}
+
+/**
+ * Copies the simulated working area back into the heights.
+ * Whatever was deposited in the apron falls outside the heightmap and is discarded.
+ */
+void UErosionLibrary::StitchPaddedGrid(FErosionContext& ErosionContext)
+{
+	const FErosionGrid& Grid = ErosionContext.Grid;
+
+	for (int32 Y = 0; Y < Grid.Size.Y; Y++)
+	{
+		float* Row = ErosionContext.GridHeights.GetData() + Y * Grid.Size.X;
+
+		if (Grid.BlockShift > 0)
+		{
+			for (int32 X = 0; X < Grid.Size.X; X++)
+			{
+				Row[X] = ErosionContext.PaddedHeights[Grid.GetIndex(X, Y)];
+			}
+
+			continue;
+		}
+
+		FMemory::Memcpy(Row, ErosionContext.PaddedHeights.GetData() + Grid.GetIndex(0, Y), Grid.Size.X * sizeof(float));
+	}
+}
+
+/**
+ * Splits the spawn bounds into square cells of "STRATIFIED_SPAWN_CELL_SIZE" (clipped on the far sides)
+ * and orders them along a Z-order curve, so cells next in the order are also next to each other on the grid.
+ */
+void UErosionLibrary::BuildSpawnStrata(FErosionWorkspace& Workspace, const FIntRect& SpawnBounds)
+{
+	// The serial erosion spawns every batch in the same bounds, build the cells once.
+	if (Workspace.SpawnStrataBounds == SpawnBounds && !Workspace.SpawnStrata.IsEmpty())
+	{
+		return;
+	}
+
+	const FIntPoint StrataCount(
+		FMath::Max(FMath::DivideAndRoundUp(SpawnBounds.Width(), STRATIFIED_SPAWN_CELL_SIZE), 1),
+		FMath::Max(FMath::DivideAndRoundUp(SpawnBounds.Height(), STRATIFIED_SPAWN_CELL_SIZE), 1));
+
+	// Tiles change bounds every round, the capacity reserved for the largest one is kept (see "ReserveWorkspace").
+	checkSlow(StrataCount.X * StrataCount.Y <= Workspace.SpawnStrata.Max());
+
+	Workspace.SpawnStrataBounds = SpawnBounds;
+	Workspace.SpawnStrata.Reset();
+
+	for (int32 Y = 0; Y < StrataCount.Y; Y++)
+	{
+		for (int32 X = 0; X < StrataCount.X; X++)
+		{
+			Workspace.SpawnStrata.Add(FIntPoint(X, Y));
+		}
+	}
+
+	Workspace.SpawnStrata.Sort([](const FIntPoint& A, const FIntPoint& B)
+		{
+			return GetMortonCode(A.X, A.Y) < GetMortonCode(B.X, B.Y);
+		});
+}
+
+/**
+ * Drops take the cells in curve order, keyed on their global index, so splitting
+ * the drops into batches or tiles keeps every cell visited once per pass.
+ */
+FIntRect UErosionLibrary::GetDropSpawnBounds(const FErosionWorkspace& Workspace, const FIntRect& SpawnBounds, const bool bStratifiedSpawn, const int64 DropIndex)
+{
+	if (!bStratifiedSpawn)
+	{
+		return SpawnBounds;
+	}
+
+	const FIntPoint& Stratum = Workspace.SpawnStrata[DropIndex % Workspace.SpawnStrata.Num()];
+	const FIntPoint StratumMin = SpawnBounds.Min + Stratum * STRATIFIED_SPAWN_CELL_SIZE;
+
+	FIntRect StratumBounds(StratumMin, StratumMin + FIntPoint(STRATIFIED_SPAWN_CELL_SIZE, STRATIFIED_SPAWN_CELL_SIZE));
+	StratumBounds.Clip(SpawnBounds);
+
+	return StratumBounds;
+}
+
+/**
+ * Builds the importance spawn distribution over cells of "IMPORTANCE_SPAWN_CELL_SIZE".
+ * The importance of a cell is its slope times the square root of the flow accumulated in it (D8 routing
+ * of the rain fallen on every cell), so drops mostly start on steep slopes and along the drainage lines,
+ * where they erode the most, and rarely on flat plateaus. It is mixed with the uniform distribution
+ * ("IMPORTANCE_SPAWN_UNIFORM_FRACTION"), which keeps every cell reachable and the drops' weights bounded.
+ */
+void UErosionLibrary::BuildSpawnDistribution(FErosionSpawnDistribution& Distribution, const TArray<float>& Heights, const FIntPoint& GridSize)
+{
+	const int32 CellSize = IMPORTANCE_SPAWN_CELL_SIZE;
+	const FIntPoint CellCount(FMath::DivideAndRoundUp(GridSize.X, CellSize), FMath::DivideAndRoundUp(GridSize.Y, CellSize));
+	const int32 NumCells = CellCount.X * CellCount.Y;
+
+	Distribution.CellSize = CellSize;
+	Distribution.CellCount = CellCount;
+
+	// Mean height and area (vertices) of every cell.
+	TArray<float> CellHeights;
+	TArray<float> CellAreas;
+	CellHeights.SetNumZeroed(NumCells);
+	CellAreas.SetNumZeroed(NumCells);
+
+	for (int32 Y = 0; Y < GridSize.Y; Y++)
+	{
+		for (int32 X = 0; X < GridSize.X; X++)
+		{
+			const int32 Cell = X / CellSize + (Y / CellSize) * CellCount.X;
+			CellHeights[Cell] += Heights[X + Y * GridSize.X];
+			CellAreas[Cell] += 1.f;
+		}
+	}
+
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		CellHeights[Cell] /= CellAreas[Cell];
+	}
+
+	// Flow accumulation: from the highest cell down, every cell passes the rain it collected to its lowest neighbour.
+	TArray<int32> CellsByHeight;
+	CellsByHeight.SetNumUninitialized(NumCells);
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		CellsByHeight[Cell] = Cell;
+	}
+
+	CellsByHeight.Sort([&CellHeights](const int32 A, const int32 B) { return CellHeights[A] > CellHeights[B]; });
+
+	TArray<float> Flow = CellAreas;
+
+	for (const int32 Cell : CellsByHeight)
+	{
+		const int32 CellX = Cell % CellCount.X;
+		const int32 CellY = Cell / CellCount.X;
+
+		int32 LowestNeighbour = INDEX_NONE;
+		float LowestHeight = CellHeights[Cell];
+
+		for (int32 OffsetY = -1; OffsetY <= 1; OffsetY++)
+		{
+			for (int32 OffsetX = -1; OffsetX <= 1; OffsetX++)
+			{
+				const int32 NeighbourX = CellX + OffsetX;
+				const int32 NeighbourY = CellY + OffsetY;
+				if ((OffsetX == 0 && OffsetY == 0) || NeighbourX < 0 || NeighbourY < 0 || NeighbourX >= CellCount.X || NeighbourY >= CellCount.Y)
+				{
+					continue;
+				}
+
+				const int32 Neighbour = NeighbourX + NeighbourY * CellCount.X;
+				if (CellHeights[Neighbour] < LowestHeight)
+				{
+					LowestNeighbour = Neighbour;
+					LowestHeight = CellHeights[Neighbour];
+				}
+			}
+		}
+
+		// Pits keep their flow.
+		if (LowestNeighbour != INDEX_NONE)
+		{
+			Flow[LowestNeighbour] += Flow[Cell];
+		}
+	}
+
+	// Importance = slope * sqrt(flow), the slope from central differences of the cell heights.
+	TArray<double> Importance;
+	Importance.SetNumUninitialized(NumCells);
+	double TotalImportance = 0.0;
+
+	for (int32 CellY = 0; CellY < CellCount.Y; CellY++)
+	{
+		for (int32 CellX = 0; CellX < CellCount.X; CellX++)
+		{
+			const int32 LeftX = FMath::Max(CellX - 1, 0);
+			const int32 RightX = FMath::Min(CellX + 1, CellCount.X - 1);
+			const int32 TopY = FMath::Max(CellY - 1, 0);
+			const int32 BottomY = FMath::Min(CellY + 1, CellCount.Y - 1);
+
+			const float GradientX = RightX > LeftX ? (CellHeights[RightX + CellY * CellCount.X] - CellHeights[LeftX + CellY * CellCount.X]) / ((RightX - LeftX) * CellSize) : 0.f;
+			const float GradientY = BottomY > TopY ? (CellHeights[CellX + BottomY * CellCount.X] - CellHeights[CellX + TopY * CellCount.X]) / ((BottomY - TopY) * CellSize) : 0.f;
+
+			const int32 Cell = CellX + CellY * CellCount.X;
+			Importance[Cell] = FMath::Sqrt(GradientX * GradientX + GradientY * GradientY) * FMath::Sqrt(Flow[Cell]);
+			TotalImportance += Importance[Cell];
+		}
+	}
+
+	// Probability of every cell, scaled so that the mean is 1, and weight of its drops.
+	const double TotalArea = static_cast<double>(GridSize.X) * GridSize.Y;
+
+	TArray<double> ScaledProbabilities;
+	ScaledProbabilities.SetNumUninitialized(NumCells);
+	Distribution.Weights.SetNumUninitialized(NumCells);
+
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		const double UniformProbability = CellAreas[Cell] / TotalArea;
+		const double Probability = TotalImportance > 0.0
+			? (1.0 - IMPORTANCE_SPAWN_UNIFORM_FRACTION) * Importance[Cell] / TotalImportance + IMPORTANCE_SPAWN_UNIFORM_FRACTION * UniformProbability
+			: UniformProbability;
+
+		ScaledProbabilities[Cell] = Probability * NumCells;
+		Distribution.Weights[Cell] = static_cast<float>(UniformProbability / Probability);
+	}
+
+	// Vose's alias method: every cell below the mean is topped up by one cell above it.
+	Distribution.Probabilities.SetNumUninitialized(NumCells);
+	Distribution.Aliases.SetNumUninitialized(NumCells);
+
+	TArray<int32> Small;
+	TArray<int32> Large;
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		(ScaledProbabilities[Cell] < 1.0 ? Small : Large).Add(Cell);
+	}
+
+	while (!Small.IsEmpty() && !Large.IsEmpty())
+	{
+		const int32 Less = Small.Pop(EAllowShrinking::No);
+		const int32 More = Large.Pop(EAllowShrinking::No);
+
+		Distribution.Probabilities[Less] = static_cast<float>(ScaledProbabilities[Less]);
+		Distribution.Aliases[Less] = More;
+
+		ScaledProbabilities[More] = (ScaledProbabilities[More] + ScaledProbabilities[Less]) - 1.0;
+		(ScaledProbabilities[More] < 1.0 ? Small : Large).Add(More);
+	}
+
+	// What is left is at the mean, up to rounding errors.
+	for (const int32 Cell : Large)
+	{
+		Distribution.Probabilities[Cell] = 1.f;
+		Distribution.Aliases[Cell] = Cell;
+	}
+
+	for (const int32 Cell : Small)
+	{
+		Distribution.Probabilities[Cell] = 1.f;
+		Distribution.Aliases[Cell] = Cell;
+	}
+}
+
+/**
+ * Picks a cell uniformly, then keeps it or takes its alias: two random numbers, whatever the number of cells.
+ */
+FIntRect UErosionLibrary::SampleSpawnDistribution(const FErosionSpawnDistribution& Distribution, const FIntRect& SpawnBounds, FErosionRandomStream& RandomStream, float& OutWater)
+{
+	const int32 PickedCell = RandomStream.RandHelper(Distribution.Probabilities.Num());
+	const int32 Cell = RandomStream.GetFraction() < Distribution.Probabilities[PickedCell] ? PickedCell : Distribution.Aliases[PickedCell];
+
+	OutWater = Distribution.Weights[Cell];
+
+	const FIntPoint CellMin = SpawnBounds.Min + FIntPoint(Cell % Distribution.CellCount.X, Cell / Distribution.CellCount.X) * Distribution.CellSize;
+
+	FIntRect CellBounds(CellMin, CellMin + FIntPoint(Distribution.CellSize, Distribution.CellSize));
+	CellBounds.Clip(SpawnBounds);
+
+	return CellBounds;
+}
+
+/**
+ * The importance spawn takes precedence over the stratified one.
+ * Drops spawned from the importance distribution carry their weight as water, which scales their carrying
+ * capacity. This only roughly compensates for the uneven spawn: the erosion of a step is also bounded by the
+ * height difference and the deposits by the sediment carried, so the result differs from the uniform spawn's.
+ */
+template<bool bWindBias, bool bRandomWind>
+FDrop& UErosionLibrary::SpawnDrop(const FErosionSettings& ErosionSettings, FDrop& Drop, const FErosionWorkspace& Workspace, const FErosionSpawnDistribution* SpawnDistribution, const FIntRect& SpawnBounds, const FIntPoint& GridSize, const int64 DropIndex)
+{
+	FErosionRandomStream RandomStream(ErosionSettings.ErosionSeed, DropIndex);
+
+	if (SpawnDistribution)
+	{
+		float Water = 1.f;
+		const FIntRect CellBounds = SampleSpawnDistribution(*SpawnDistribution, SpawnBounds, RandomStream, Water);
+
+		InitDrop<bWindBias, bRandomWind>(ErosionSettings, Drop, CellBounds, GridSize, RandomStream);
+		Drop.Water = Water;
+
+		return Drop;
+	}
+
+	return InitDrop<bWindBias, bRandomWind>(ErosionSettings, Drop, GetDropSpawnBounds(Workspace, SpawnBounds, ErosionSettings.bStratifiedSpawn, DropIndex), GridSize, RandomStream);
+}
+
+/**
+ * Spawns and simulates the drops ["FirstDrop", "FirstDrop" + "NumDrops") in order.
+ * With the vectorized kernel enabled, drops are grouped in batches of "FDropBatch::NumLanes";
+ * each drop keeps the random stream of its own global index either way.
+ * With the stratified spawn, consecutive drops start in consecutive cells of a Z-order curve.
+ */
+template<int32 Radius, bool bWindBias, bool bRandomWind>
+void UErosionLibrary::SimulateDrops(TArray<float>& GridHeights, FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FErosionSettings& ErosionSettings, const FErosionGrid& Grid, const FErosionSpawnDistribution* SpawnDistribution, const FIntRect& SpawnBounds, const FIntRect& DropBounds, const int64 FirstDrop, const int64 NumDrops)
+{
+	if (ErosionSettings.bStratifiedSpawn && !SpawnDistribution)
+	{
+		BuildSpawnStrata(Workspace, SpawnBounds);
+	}
+
+	if (!ErosionSettings.bVectorizedErosion)
+	{
+		for (int64 Index = 0; Index < NumDrops; Index++)
+		{
+			FDrop Drop;
+			SpawnDrop<bWindBias, bRandomWind>(ErosionSettings, Drop, Workspace, SpawnDistribution, SpawnBounds, Grid.Size, FirstDrop + Index);
+			ApplyErosion<Radius>(GridHeights, Workspace, Brush, ErosionSettings, Drop, Grid, DropBounds);
+
+			// Drop completes its lifecycle.
+		}
+
+		return;
+	}
+
+	for (int64 BatchIndex = 0; BatchIndex < NumDrops; BatchIndex += FDropBatch::NumLanes)
+	{
+		FDropBatch Batch;
+
+		for (int32 Lane = 0; Lane < FDropBatch::NumLanes; Lane++)
+		{
+			FDrop Drop = { FVector2f::ZeroVector, FVector2f::ZeroVector, 0.f, 0.f };
+
+			// Lanes past the last drop stay empty.
+			Batch.bAlive[Lane] = BatchIndex + Lane < NumDrops;
+			if (Batch.bAlive[Lane])
+			{
+				SpawnDrop<bWindBias, bRandomWind>(ErosionSettings, Drop, Workspace, SpawnDistribution, SpawnBounds, Grid.Size, FirstDrop + BatchIndex + Lane);
+			}
+
+			Batch.PositionX[Lane] = Drop.Position.X;
+			Batch.PositionY[Lane] = Drop.Position.Y;
+			Batch.DirectionX[Lane] = Drop.Direction.X;
+			Batch.DirectionY[Lane] = Drop.Direction.Y;
+			Batch.Velocity[Lane] = Drop.Velocity;
+			Batch.Water[Lane] = Drop.Water;
+		}
+
+		ApplyErosionBatch<Radius>(GridHeights, Workspace, Brush, ErosionSettings, Batch, Grid, DropBounds);
+	}
+}
+
+/**
+ * Simulates all the drops one after the other on the calling thread.
+ * Every drop sees the heightmap left by all the previous ones.
+ */
+bool UErosionLibrary::ErosionSerial(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, const FSimulateDropsFunction SimulateDropsFunction, FErosionProgress* Progress)
+{
+	// Pre-allocate memory for points and weights based on erosion radius.
+	ReserveWorkspace(ErosionContext.Workspace, ErosionContext.Brush, GridSize);
+
+	const FIntRect GridBounds(FIntPoint::ZeroValue, GridSize);
+
+	// Importance distribution of the heights before the erosion, covering the whole grid like the spawn bounds.
+	const FErosionSpawnDistribution* SpawnDistribution = nullptr;
+	if (ErosionSettings.bImportanceSpawn)
+	{
+		BuildSpawnDistribution(ErosionContext.SpawnDistribution, ErosionContext.GridHeights, GridSize);
+		SpawnDistribution = &ErosionContext.SpawnDistribution;
+	}
+
+	// Simulate multiple drops for specified number of erosion cycles.
+	// Drops are keyed on their global index, so splitting them into batches does not change the result.
+	int64 BatchDrops = EROSION_PROGRESS_DROPS_PER_BATCH;
+	int64 NumDrops = 0;
+
+	for (int64 FirstDrop = 0; FirstDrop < ErosionSettings.ErosionCycles; FirstDrop += NumDrops)
+	{
+		if (Progress && Progress->IsCancelRequested())
+		{
+			return false;
+		}
+
+		NumDrops = FMath::Min<int64>(BatchDrops, ErosionSettings.ErosionCycles - FirstDrop);
+
+		SimulateDropsFunction(ErosionContext.PaddedHeights, ErosionContext.Workspace, ErosionContext.Brush, ErosionSettings, ErosionContext.Grid, SpawnDistribution, GridBounds, GridBounds, FirstDrop, NumDrops);
+
+		if (Progress)
+		{
+			Progress->SimulatedDrops.fetch_add(NumDrops, std::memory_order_relaxed);
+		}
+
+		const double HeightChange = ErosionContext.Workspace.HeightChange;
+		ErosionContext.Workspace.HeightChange = 0.0;
+
+		if (ShouldStopErosion(ErosionContext.Convergence, ErosionSettings, HeightChange, NumDrops, Progress))
+		{
+			break;
+		}
+
+		BatchDrops = UpdateTimeBudget(ErosionContext.Convergence, ErosionSettings, FirstDrop + NumDrops, Progress);
+	}
+
+	return true;
+}
+
+/**
+ * Measures the drops simulated per second since the start on the current machine, then sizes the next batch
+ * to end at the next check ("EROSION_TIME_BUDGET_CHECK_INTERVAL") or with the budget, whichever comes first,
+ * and estimates the drops the whole budget allows so the progress follows the time rather than the erosion cycles.
+ */
+int64 UErosionLibrary::UpdateTimeBudget(const FErosionConvergence& Convergence, const FErosionSettings& ErosionSettings, const int64 SimulatedDrops, FErosionProgress* Progress)
+{
+	if (ErosionSettings.ErosionTimeBudget <= 0.f)
+	{
+		return EROSION_PROGRESS_DROPS_PER_BATCH;
+	}
+
+	const double ElapsedSeconds = FMath::Max(FPlatformTime::Seconds() - Convergence.StartTime, UE_DOUBLE_SMALL_NUMBER);
+	const double RemainingSeconds = FMath::Max(ErosionSettings.ErosionTimeBudget - ElapsedSeconds, 0.0);
+	const double DropsPerSecond = SimulatedDrops / ElapsedSeconds;
+
+	if (Progress)
+	{
+		// Drops of the earlier passes of a multiresolution erosion, already in the progress.
+		const int64 EarlierDrops = Progress->SimulatedDrops.load(std::memory_order_relaxed) - SimulatedDrops;
+		const int64 EstimatedDrops = SimulatedDrops + static_cast<int64>(DropsPerSecond * RemainingSeconds);
+		Progress->TotalDrops.store(EarlierDrops + FMath::Clamp(EstimatedDrops, SimulatedDrops, ErosionSettings.ErosionCycles), std::memory_order_relaxed);
+	}
+
+	const double BatchSeconds = FMath::Min(RemainingSeconds, EROSION_TIME_BUDGET_CHECK_INTERVAL);
+	return FMath::Max<int64>(static_cast<int64>(DropsPerSecond * BatchSeconds), EROSION_TIME_BUDGET_MIN_DROPS);
+}
+
+/**
+ * The adaptive erosion compares the mean absolute height change per drop, smoothed over the batches,
+ * with the one of the first batch: drops carve the most on the untouched terrain and less and less
+ * as it settles, so the ratio tells how much the erosion still changes the heights, whatever their scale.
+ * The time budget is checked between batches of drops too, so it can be exceeded by up to one batch.
+ */
+bool UErosionLibrary::ShouldStopErosion(FErosionConvergence& Convergence, const FErosionSettings& ErosionSettings, const double HeightChange, const int64 NumDrops, FErosionProgress* Progress)
+{
+	if (NumDrops <= 0)
+	{
+		return false;
+	}
+
+	if (ErosionSettings.bAdaptiveErosion)
+	{
+		const double Change = HeightChange / NumDrops;
+
+		if (Convergence.FirstChange < 0.0)
+		{
+			Convergence.FirstChange = Change;
+			Convergence.SmoothedChange = Change;
+		}
+		else
+		{
+			Convergence.SmoothedChange += EROSION_CONVERGENCE_SMOOTHING * (Change - Convergence.SmoothedChange);
+		}
+
+		if (Convergence.SmoothedChange <= ErosionSettings.ConvergenceThreshold * Convergence.FirstChange)
+		{
+			if (Progress)
+			{
+				Progress->bConverged.store(true, std::memory_order_relaxed);
+			}
+
+			return true;
+		}
+	}
+
+	if (ErosionSettings.ErosionTimeBudget > 0.f && FPlatformTime::Seconds() - Convergence.StartTime >= ErosionSettings.ErosionTimeBudget)
+	{
+		if (Progress)
+		{
+			Progress->bOutOfTime.store(true, std::memory_order_relaxed);
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Splits the grid into tiles for a parallel round and distributes the round's drops among them.
+ * Drops are assigned proportionally to the area of each (clipped) tile, so the spawn density
+ * stays uniform over the whole grid like in the serial simulation.
+ */
+void UErosionLibrary::BuildErosionTiles(TArray<FErosionTile>& Tiles, const int32 TileSize, const FIntPoint& TileCount, const FIntPoint& Shift, const int32 Margin, const int64 RoundFirstDrop, const int64 RoundDrops, const FIntPoint& GridSize)
+{
+	const FIntRect GridBounds(FIntPoint::ZeroValue, GridSize);
+	const int64 GridArea = static_cast<int64>(GridSize.X) * GridSize.Y;
+
+	int64 CoveredArea = 0;
+	int64 AssignedDrops = 0;
+
+	for (int32 TileY = 0; TileY < TileCount.Y; TileY++)
+	{
+		for (int32 TileX = 0; TileX < TileCount.X; TileX++)
+		{
+			FErosionTile& Tile = Tiles[TileX + TileY * TileCount.X];
+
+			// Tile cells, clipped to the grid.
+			const FIntPoint TileMin(TileX * TileSize - Shift.X, TileY * TileSize - Shift.Y);
+			Tile.Bounds = FIntRect(TileMin, TileMin + FIntPoint(TileSize, TileSize));
+			Tile.Bounds.Clip(GridBounds);
+
+			// Cells reachable by the drops of the tile, clipped to the grid.
+			Tile.DropBounds = FIntRect(TileMin - FIntPoint(Margin, Margin), TileMin + FIntPoint(TileSize + Margin, TileSize + Margin));
+			Tile.DropBounds.Clip(GridBounds);
+
+			// Cumulative rounding keeps the total number of drops exact.
+			CoveredArea += Tile.Bounds.Area();
+			const int64 DropsUpToTile = RoundDrops * CoveredArea / GridArea;
+
+			Tile.NumDrops = DropsUpToTile - AssignedDrops;
+			Tile.FirstDrop = RoundFirstDrop + AssignedDrops;
+
+			AssignedDrops = DropsUpToTile;
+		}
+	}
+
+	// Every round drop is assigned only if the tiles cover the whole grid.
+	check(CoveredArea == GridArea);
+}
+
+/**
+ * Simulates the drops in parallel using a tiled "4-colour" schedule.
+ * The grid is split into square tiles, coloured by the parity of their coordinates.
+ * All the tiles of one colour are simulated at the same time through "ParallelFor", then the next colour follows.
+ * Drops are stopped when they stray more than half a tile (minus their footprint) outside their own tile,
+ * so two tiles of the same colour, which are always one full tile apart, never read or write the same cells.
+ * The tile grid is randomly shifted every round to avoid visible seams along the tile borders.
+ * Every drop keeps the random stream of its global index, so the result does not depend on the number of threads.
+ */
+bool UErosionLibrary::ErosionParallel(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, const FSimulateDropsFunction SimulateDropsFunction, FErosionProgress* Progress)
+{
+	// Cells touched around the drop position: brush radius plus the bilinear corner.
+	const int32 Footprint = ErosionSettings.ErosionRadius + 2;
+	const int32 TileSize = FMath::Max(ErosionSettings.ParallelTileSize, 4 * Footprint);
+	const int32 Margin = TileSize / 2 - Footprint;
+
+	// One extra tile per axis, so the tile grid shifted by up to a tile always covers the whole heightmap.
+	const FIntPoint TileCount(FMath::DivideAndRoundUp(GridSize.X, TileSize) + 1, FMath::DivideAndRoundUp(GridSize.Y, TileSize) + 1);
+	const int64 DropsPerRound = FMath::Max<int64>(PARALLEL_EROSION_MIN_DROPS_PER_ROUND, static_cast<int64>(TileCount.X) * TileCount.Y * PARALLEL_EROSION_DROPS_PER_TILE);
+
+	TArray<FErosionTile> Tiles;
+	Tiles.SetNum(TileCount.X * TileCount.Y);
+
+	// One workspace for each tile of the most populated colour, allocated once for the whole simulation.
+	// Only the task dispatch of "ParallelFor" still allocates during the rounds.
+	TArray<FErosionWorkspace> Workspaces;
+	Workspaces.SetNum(((TileCount.X + 1) / 2) * ((TileCount.Y + 1) / 2));
+	for (FErosionWorkspace& Workspace : Workspaces)
+	{
+		ReserveWorkspace(Workspace, ErosionContext.Brush, FIntPoint(TileSize, TileSize));
+	}
+
+	for (int64 FirstDrop = 0, Round = 0; FirstDrop < ErosionSettings.ErosionCycles; FirstDrop += DropsPerRound, Round++)
+	{
+		const int64 RoundDrops = FMath::Min(DropsPerRound, ErosionSettings.ErosionCycles - FirstDrop);
+
+		// Rounds are keyed down from the last index, so their streams never overlap with the drops' ones
+		// and do not depend on the erosion cycles: a run stopped early is reproduced by asking for the drops it simulated.
+		FErosionRandomStream RoundStream(ErosionSettings.ErosionSeed, MAX_int64 - Round);
+		const FIntPoint Shift(RoundStream.RandHelper(TileSize), RoundStream.RandHelper(TileSize));
+
+		BuildErosionTiles(Tiles, TileSize, TileCount, Shift, Margin, FirstDrop, RoundDrops, GridSize);
+
+		// Colour = (TileX % 2, TileY % 2): tiles of the same colour are never adjacent.
+		for (int32 Colour = 0; Colour < 4; Colour++)
+		{
+			const int32 FirstTileX = Colour & 1;
+			const int32 FirstTileY = Colour >> 1;
+			const int32 ColourTilesX = (TileCount.X - FirstTileX + 1) / 2;
+			const int32 ColourTilesY = (TileCount.Y - FirstTileY + 1) / 2;
+
+			ParallelFor(ColourTilesX * ColourTilesY, [&](const int32 ColourTileIndex)
+				{
+					const int32 TileX = FirstTileX + 2 * (ColourTileIndex % ColourTilesX);
+					const int32 TileY = FirstTileY + 2 * (ColourTileIndex / ColourTilesX);
+					const FErosionTile& Tile = Tiles[TileX + TileY * TileCount.X];
+
+					// Tiles not started yet are skipped as soon as a cancel is requested.
+					if (Tile.NumDrops <= 0 || (Progress && Progress->IsCancelRequested()))
+					{
+						return;
+					}
+
+					FErosionWorkspace& Workspace = Workspaces[ColourTileIndex];
+
+					SimulateDropsFunction(ErosionContext.PaddedHeights, Workspace, ErosionContext.Brush, ErosionSettings, ErosionContext.Grid, nullptr, Tile.Bounds, Tile.DropBounds, Tile.FirstDrop, Tile.NumDrops);
+
+					if (Progress)
+					{
+						Progress->SimulatedDrops.fetch_add(Tile.NumDrops, std::memory_order_relaxed);
+					}
+				});
+
+			if (Progress && Progress->IsCancelRequested())
+			{
+				return false;
+			}
+		}
+
+		// Rounds are the batches of the adaptive erosion.
+		double HeightChange = 0.0;
+		for (FErosionWorkspace& Workspace : Workspaces)
+		{
+			HeightChange += Workspace.HeightChange;
+			Workspace.HeightChange = 0.0;
+		}
+
+		if (ShouldStopErosion(ErosionContext.Convergence, ErosionSettings, HeightChange, RoundDrops, Progress))
+		{
+			break;
+		}
+
+		// Round sizes shape the result, so the time budget only updates the progress estimate here.
+		UpdateTimeBudget(ErosionContext.Convergence, ErosionSettings, FirstDrop + RoundDrops, Progress);
+	}
+
+	return true;
+}
+
+/**
+ * Simulates the drops on a working copy of the heights kept in a tile file, paged through a bounded "FErosionTileCache".
+ * "GridHeights" is released while the drops are simulated, so only the cache, one window and the workspace stay in memory;
+ * the heights are read back in full once done, from the eroded tiles or, if the erosion did not complete, the original ones.
+ * Drops are distributed like in the parallel erosion: the grid is split into randomly shifted tiles and the drops of a tile
+ * never stray more than half a tile from it. Tiles are then simulated one after the other, each on a window holding the cells
+ * its drops can reach, read from the cache and written back right after. Rows of tiles are walked back and forth,
+ * so consecutive windows share most of their tiles and the cache mostly serves them from memory.
+ */
+bool UErosionLibrary::ErosionOutOfCore(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, const FSimulateDropsFunction SimulateDropsFunction, FErosionProgress* Progress)
+{
+	// Same tile layout as the parallel erosion.
+	const int32 Footprint = ErosionSettings.ErosionRadius + 2;
+	const int32 TileSize = FMath::Max(ErosionSettings.OutOfCoreTileSize, 4 * Footprint);
+	const int32 Margin = TileSize / 2 - Footprint;
+
+	const FIntPoint TileCount(FMath::DivideAndRoundUp(GridSize.X, TileSize) + 1, FMath::DivideAndRoundUp(GridSize.Y, TileSize) + 1);
+	const int64 DropsPerRound = FMath::Max<int64>(PARALLEL_EROSION_MIN_DROPS_PER_ROUND, static_cast<int64>(TileCount.X) * TileCount.Y * PARALLEL_EROSION_DROPS_PER_TILE);
+
+	TArray<FErosionTile> Tiles;
+	Tiles.SetNum(TileCount.X * TileCount.Y);
+
+	// Copy the heights into a scratch tile file, unique to this simulation.
+	const FString TileFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT(EROSION_TILE_FILE_DIRECTORY), FGuid::NewGuid().ToString() + TEXT(".tiles"));
+	const int64 MemoryBudget = static_cast<int64>(FMath::Max(ErosionSettings.OutOfCoreMemoryBudget, 1)) * 1024 * 1024;
+
+	FErosionTileCache TileCache;
+	if (!TileCache.Open(TileFilePath, GridSize, TileSize, MemoryBudget) || !TileCache.WriteHeights(ErosionContext.GridHeights))
+	{
+		return false;
+	}
+
+	// Neither the heights nor the in-core padded grid are needed until the end, release them.
+	ErosionContext.GridHeights.Empty();
+	ErosionContext.PaddedHeights.Empty();
+
+	// A cancelled or failed erosion reads the heights back as they were written.
+	auto RestoreHeights = [&ErosionContext, &TileCache]()
+		{
+			if (!TileCache.ReadOriginalHeights(ErosionContext.GridHeights))
+			{
+				ErosionContext.GridHeights.Empty();
+				UE_LOG(LogDropByDropErosion, Error, TEXT("Unable to restore the heights from the erosion tile file!"));
+			}
+
+			return false;
+		};
+
+	// Window of a tile: its drop bounds plus their footprint, surrounded by the apron.
+	// The stride is the same for every window, so a single brush fits all of them.
+	const int32 MaxWindowSize = TileSize + 2 * (Margin + Footprint);
+
+	FErosionGrid WindowGrid;
+	WindowGrid.Padding = 1 + ErosionSettings.ErosionRadius;
+	WindowGrid.Stride = MaxWindowSize + 2 * WindowGrid.Padding;
+
+	TArray<float> WindowHeights;
+	WindowHeights.SetNumUninitialized(WindowGrid.Stride * WindowGrid.Stride);
+
+	if (ErosionContext.Brush.Radius != ErosionSettings.ErosionRadius || ErosionContext.Brush.Stride != WindowGrid.Stride)
+	{
+		BuildErosionBrush(ErosionContext.Brush, ErosionSettings.ErosionRadius, WindowGrid.Stride);
+	}
+
+	ReserveWorkspace(ErosionContext.Workspace, ErosionContext.Brush, FIntPoint(TileSize, TileSize));
+
+	const FIntRect GridBounds(FIntPoint::ZeroValue, GridSize);
+
+	for (int64 FirstDrop = 0, Round = 0; FirstDrop < ErosionSettings.ErosionCycles; FirstDrop += DropsPerRound, Round++)
+	{
+		const int64 RoundDrops = FMath::Min(DropsPerRound, ErosionSettings.ErosionCycles - FirstDrop);
+
+		// Same shift as the parallel erosion for the same round.
+		FErosionRandomStream RoundStream(ErosionSettings.ErosionSeed, MAX_int64 - Round);
+		const FIntPoint Shift(RoundStream.RandHelper(TileSize), RoundStream.RandHelper(TileSize));
+
+		BuildErosionTiles(Tiles, TileSize, TileCount, Shift, Margin, FirstDrop, RoundDrops, GridSize);
+
+		for (int32 TileY = 0; TileY < TileCount.Y; TileY++)
+		{
+			for (int32 Column = 0; Column < TileCount.X; Column++)
+			{
+				// Odd rows are walked backwards, starting next to the last tile of the previous row.
+				const int32 TileX = TileY % 2 == 0 ? Column : TileCount.X - 1 - Column;
+				const FErosionTile& Tile = Tiles[TileX + TileY * TileCount.X];
+
+				if (Tile.NumDrops <= 0)
+				{
+					continue;
+				}
+
+				if (Progress && Progress->IsCancelRequested())
+				{
+					return RestoreHeights();
+				}
+
+				// Cells read or written by the drops of the tile, in grid coordinates.
+				FIntRect Window(Tile.DropBounds.Min - FIntPoint(Footprint, Footprint), Tile.DropBounds.Max + FIntPoint(Footprint, Footprint));
+				Window.Clip(GridBounds);
+
+				WindowGrid.Size = Window.Size();
 
-	return InCornersHeights;
-}
+				if (!TileCache.ReadRegion(Window, WindowHeights.GetData() + WindowGrid.GetIndex(0, 0), WindowGrid.Stride))
+				{
+					return RestoreHeights();
+				}
 
-/**
- * Performs bilinear interpolation using corner heights and offset position.
- * Standard bilinear interpolation formula for smooth height calculation within a cell.
- */
-float UErosionLibrary::GetBilinearInterpolation(const FVector2D& OffsetPosition, const FCornersHeights& CornersHeights)
-{
-	return CornersHeights.X_Y * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y) +
-		CornersHeights.X1_Y * OffsetPosition.X * (1 - OffsetPosition.Y) +
-		CornersHeights.X_Y1 * (1 - OffsetPosition.X) * OffsetPosition.Y +
-		CornersHeights.X1_Y1 * OffsetPosition.X * OffsetPosition.Y;
-}
+				PadErosionWindow(WindowHeights, WindowGrid);
 
-/**
- * Identifies and stores all grid points within the erosion radius of the drop.
- * Creates a square area centered on the drop position with side length = 2 * radius + 1.
- * Example: radius = 1 -> 9 points, radius = 2 -> 25 points, radius = 3 -> 49 points...
- */
-void UErosionLibrary::SetInRadiusPoints(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FVector2D& DropPosition, const int32 GridSize)
-{
-	// Iterate through square area around drop position.
-	for (int32 Y = -ErosionSettings.ErosionRadius; Y <= ErosionSettings.ErosionRadius; Y++)
-	{
-		for (int32 X = -ErosionSettings.ErosionRadius; X <= ErosionSettings.ErosionRadius; X++)
-		{
-			const float PosX = FMath::Floor(DropPosition.X) + X;
-			const float PosY = FMath::Floor(DropPosition.Y) + Y;
+				// Drops move in window coordinates.
+				const FIntRect SpawnBounds(Tile.Bounds.Min - Window.Min, Tile.Bounds.Max - Window.Min);
+				const FIntRect DropBounds(Tile.DropBounds.Min - Window.Min, Tile.DropBounds.Max - Window.Min);
 
-			FVector2D Position(PosX, PosY);
+				SimulateDropsFunction(WindowHeights, ErosionContext.Workspace, ErosionContext.Brush, ErosionSettings, WindowGrid, nullptr, SpawnBounds, DropBounds, Tile.FirstDrop, Tile.NumDrops);
 
-			// Skip points outside valid grid bounds.
-			if (IsOutOfBound(Position, GridSize))
-			{
-				continue;
+				if (!TileCache.WriteRegion(Window, WindowHeights.GetData() + WindowGrid.GetIndex(0, 0), WindowGrid.Stride))
+				{
+					return RestoreHeights();
+				}
+
+				if (Progress)
+				{
+					Progress->SimulatedDrops.fetch_add(Tile.NumDrops, std::memory_order_relaxed);
+				}
 			}
+		}
 
-			ErosionContext.Points.Add(Position);
+		// Rounds are the batches of the adaptive erosion.
+		const double HeightChange = ErosionContext.Workspace.HeightChange;
+		ErosionContext.Workspace.HeightChange = 0.0;
+
+		if (ShouldStopErosion(ErosionContext.Convergence, ErosionSettings, HeightChange, RoundDrops, Progress))
+		{
+			break;
 		}
+
+		UpdateTimeBudget(ErosionContext.Convergence, ErosionSettings, FirstDrop + RoundDrops, Progress);
 	}
-}
 
-/**
- * Calculates the relative weight of a point based on its distance from the drop.
- * Uses squared distance for efficiency, with weight decreasing as distance increases.
- */
-float UErosionLibrary::GetRelativeWeightOnPoint(const FErosionSettings& ErosionSettings, const FVector2D& DropPosition, const FVector2D& PointPosition)
-{
-	const int32 SquaredErosionRadius = ErosionSettings.ErosionRadius * ErosionSettings.ErosionRadius;
+	UE_LOG(LogDropByDropErosion, Log, TEXT("Out-of-core erosion paged %lld tiles from disk (%lld served from memory)."), TileCache.Misses, TileCache.Hits);
 
-	// Weight = max(0, radius^2 - distance^2)
-	return FMath::Max(0, SquaredErosionRadius - (PointPosition - DropPosition).SquaredLength());
+	if (!TileCache.ReadHeights(ErosionContext.GridHeights))
+	{
+		return RestoreHeights();
+	}
+
+	return true;
 }
 
 /**
- * Calculates erosion amounts for all affected points based on weights.
- * Multiplies each point's weight by the erosion factor to get final erosion value.
+ * Replicates the border heights of the window into its apron, like "BuildPaddedGrid" does for the whole grid.
+ * Only the apron along the grid border is ever read: elsewhere the drops stop a whole footprint before the window edge.
  */
-TArray<float> UErosionLibrary::GetErosionOnPoints(const FErosionContext& ErosionContext, const float ErosionFactor)
+void UErosionLibrary::PadErosionWindow(TArray<float>& WindowHeights, const FErosionGrid& Grid)
 {
-	TArray<float> ErosionValues;
-	ErosionValues.Reserve(ErosionContext.Points.Num());
+	float* Heights = WindowHeights.GetData();
+	const int32 Padding = Grid.Padding;
 
-	// Calculate erosion for each point proportional to its weight.
-	for (int32 Index = 0; Index < ErosionContext.Points.Num(); Index++)
+	// Left and right apron of the working rows.
+	for (int32 Y = 0; Y < Grid.Size.Y; Y++)
 	{
-		ErosionValues.Add(ErosionContext.SquaredWeights[Index] * ErosionFactor);
+		float* Row = Heights + Grid.GetIndex(0, Y);
+
+		for (int32 X = 1; X <= Padding; X++)
+		{
+			Row[-X] = Row[0];
+			Row[Grid.Size.X - 1 + X] = Row[Grid.Size.X - 1];
+		}
 	}
 
-	return ErosionValues;
+	// Top and bottom apron, copies of the first and last padded rows.
+	const SIZE_T RowBytes = (Grid.Size.X + 2 * Padding) * sizeof(float);
+	const float* FirstRow = Heights + Grid.GetIndex(-Padding, 0);
+	const float* LastRow = Heights + Grid.GetIndex(-Padding, Grid.Size.Y - 1);
+
+	for (int32 Y = 1; Y <= Padding; Y++)
+	{
+		FMemory::Memcpy(Heights + Grid.GetIndex(-Padding, -Y), FirstRow, RowBytes);
+		FMemory::Memcpy(Heights + Grid.GetIndex(-Padding, Grid.Size.Y - 1 + Y), LastRow, RowBytes);
+	}
 }
 
 /**
- * Distributes sediment deposit across nearby grid points using bilinear interpolation.
- * Handles boundary cases where deposit position is at or beyond grid edges.
+ * Kernels specialized for radius 1 to "MAX_SPECIALIZED_EROSION_RADIUS" (index = radius) plus the generic one (index 0).
  */
-void UErosionLibrary::ComputeDepositOnPoints(FErosionContext& ErosionContext, const FVector2D& IntegerPosition, const FVector2D& OffsetPosition, const float Deposit, const int32 GridSize)
+template<bool bWindBias, bool bRandomWind, int32... Radii>
+FSimulateDropsFunction UErosionLibrary::GetSimulateDropsFunction(const int32 Radius, TIntegerSequence<int32, Radii...>)
 {
-	switch (GetOutOfBoundAsResult(IntegerPosition, GridSize))
+	static constexpr FSimulateDropsFunction Functions[] =
 	{
-		case Error_Right_Down:
-			// Both coordinates out of bounds: deposit all to last cell.
-			ErosionContext.GridHeights[GridSize * GridSize - 1] += Deposit * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y);
-			break;
-		case Error_Right:
-			// X out of bounds: distribute between two valid Y positions.
-			ErosionContext.GridHeights[IntegerPosition.X + IntegerPosition.Y * GridSize] += Deposit * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y);
-			ErosionContext.GridHeights[(IntegerPosition.X + GridSize) + IntegerPosition.Y * GridSize] += Deposit * (1 - OffsetPosition.X) * OffsetPosition.Y;
-			break;
-		case Error_Down:
-			// Y out of bounds: distribute between two valid X positions.
-			ErosionContext.GridHeights[IntegerPosition.X + IntegerPosition.Y * GridSize] += Deposit * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y);
-			ErosionContext.GridHeights[(IntegerPosition.X + 1) + IntegerPosition.Y * GridSize] += Deposit * OffsetPosition.X * (1 - OffsetPosition.Y);
-			break;
-		case No_Error:
-			// All positions valid: distribute using bilinear interpolation weights.
-			ErosionContext.GridHeights[IntegerPosition.X + IntegerPosition.Y * GridSize] += Deposit * (1 - OffsetPosition.X) * (1 - OffsetPosition.Y);        // P(x, y)
-			ErosionContext.GridHeights[(IntegerPosition.X + 1) + IntegerPosition.Y * GridSize] += Deposit * OffsetPosition.X * (1 - OffsetPosition.Y);        // P(x + 1, y)
-			ErosionContext.GridHeights[(IntegerPosition.X + GridSize) + IntegerPosition.Y * GridSize] += Deposit * (1 - OffsetPosition.X) * OffsetPosition.Y; // P(x, y + 1)
-			ErosionContext.GridHeights[(IntegerPosition.X + GridSize + 1) + IntegerPosition.Y * GridSize] += Deposit * OffsetPosition.X * OffsetPosition.Y;   // P(x + 1, y + 1)
-			break;
-	}
+		&UErosionLibrary::SimulateDrops<Radii == 0 ? GENERIC_EROSION_RADIUS : Radii, bWindBias, bRandomWind>...
+	};
+
+	return Functions[Radius >= 1 && Radius <= MAX_SPECIALIZED_EROSION_RADIUS ? Radius : 0];
 }
 
 /**
- * Checks if a position is outside the valid grid boundaries.
- * Returns true if any coordinate is negative or exceeds grid size.
+ * Picks the kernel once per simulation, so the radius and the wind options are constants in the hot loop.
  */
-bool UErosionLibrary::IsOutOfBound(const FVector2D& DropPosition, const int32 GridSize)
+FSimulateDropsFunction UErosionLibrary::GetSimulateDropsFunction(const FErosionSettings& ErosionSettings)
 {
-	return DropPosition.X < 0 || DropPosition.X >= GridSize || DropPosition.Y < 0 || DropPosition.Y >= GridSize;
+	using FRadii = TMakeIntegerSequence<int32, MAX_SPECIALIZED_EROSION_RADIUS + 1>;
+
+	float MeanAngle = 0.f;
+	const bool bRandomWind = !TryGetWindMeanAngleDegrees(ErosionSettings, MeanAngle);
+	const int32 Radius = ErosionSettings.ErosionRadius;
+
+	if (ErosionSettings.bWindBias)
+	{
+		return bRandomWind ? GetSimulateDropsFunction<true, true>(Radius, FRadii()) : GetSimulateDropsFunction<true, false>(Radius, FRadii());
+	}
+
+	return bRandomWind ? GetSimulateDropsFunction<false, true>(Radius, FRadii()) : GetSimulateDropsFunction<false, false>(Radius, FRadii());
 }
 
 /**
- * Determines which boundary (if any) a position exceeds.
- * Checks if position is at the last valid cell (GridSize - 1) which needs special handling.
+ * Main erosion simulation entry point.
+ * Simulates multiple water drops to erode the landscape over many iterations,
+ * either serially or in parallel depending on the erosion settings.
  */
-EOutOfBoundResult UErosionLibrary::GetOutOfBoundAsResult(const FVector2D& IntegerPosition, const int32 GridSize)
+bool UErosionLibrary::Erosion(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, FErosionProgress* Progress)
 {
-	const bool bOutOfBoundsOnX = IntegerPosition.X >= GridSize - 1;
-	const bool bOutOfBoundsOnY = IntegerPosition.Y >= GridSize - 1;
-
-	if (bOutOfBoundsOnX && bOutOfBoundsOnY)
+	if (GridSize.X <= 0 || GridSize.Y <= 0 || ErosionContext.GridHeights.Num() != static_cast<int64>(GridSize.X) * GridSize.Y)
 	{
-		return EOutOfBoundResult::Error_Right_Down;
+		UE_LOG(LogDropByDropErosion, Error, TEXT("The heights to erode do not match a %dx%d grid!"), GridSize.X, GridSize.Y);
+		return false;
 	}
 
-	if (bOutOfBoundsOnX)
+	if (ErosionSettings.bImportanceSpawn && (ErosionSettings.bParallelErosion || ErosionSettings.bOutOfCoreErosion))
 	{
-		return EOutOfBoundResult::Error_Right;
+		UE_LOG(LogDropByDropErosion, Warning, TEXT("The importance spawn is only supported by the single-threaded erosion, the drops are spawned uniformly."));
 	}
 
-	if (bOutOfBoundsOnY)
+	if (Progress)
 	{
-		return EOutOfBoundResult::Error_Down;
+		Progress->TotalDrops.store(ErosionSettings.ErosionCycles, std::memory_order_relaxed);
+		Progress->SimulatedDrops.store(0, std::memory_order_relaxed);
+		Progress->bConverged.store(false, std::memory_order_relaxed);
+		Progress->bOutOfTime.store(false, std::memory_order_relaxed);
 	}
 
-	return EOutOfBoundResult::No_Error;
+	return ErosionSettings.bMultiresolutionErosion && !ErosionSettings.bOutOfCoreErosion
+		? ErosionMultiresolution(ErosionContext, ErosionSettings, GridSize, Progress)
+		: ErosionPass(ErosionContext, ErosionSettings, GridSize, Progress);
 }
 
 /**
- * Calculates wind direction vector from erosion settings.
- * Uses "Box-Muller" algorithm for "Gaussian distribution" if wind bias is enabled.
- * Direction can be cardinal, diagonal, or random with optional bias variation.
+ * Drops are added to the progress without resetting it, so the passes of a multiresolution erosion add up.
  */
-FVector2D UErosionLibrary::GetWindDirection(const FErosionSettings& ErosionSettings)
+bool UErosionLibrary::ErosionPass(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, FErosionProgress* Progress)
 {
-	const float MinAngle = 0.f;
-	const float MaxAngle = 360.f;
-	const float Sigma = 35.f;  // Standard deviation for "Gaussian distribution".
-	float Mu = 0.f;  // Mean angle.
-
-	// Top-Left Pivot coordinate system.
-	// Determine base wind angle from cardinal/diagonal direction.
-	switch (ErosionSettings.WindDirection)
+	// Power-of-two blocks, or rows if the block size is below 2.
+	const int32 BlockShift = ErosionSettings.GridBlockSize > 1 ? FMath::CeilLogTwo(static_cast<uint32>(ErosionSettings.GridBlockSize)) : 0;
+	const int64 BlockSize = 1ll << BlockShift;
+
+	// Indices into the padded grid are 32-bit (the out-of-core erosion only pads small windows).
+	const int32 Padding = 1 + ErosionSettings.ErosionRadius;
+	const int64 PaddedCells = FMath::DivideAndRoundUp<int64>(GridSize.X + 2 * Padding, BlockSize) * FMath::DivideAndRoundUp<int64>(GridSize.Y + 2 * Padding, BlockSize) * BlockSize * BlockSize;
+	if (!ErosionSettings.bOutOfCoreErosion && PaddedCells > MAX_int32)
 	{
-		case EWindDirection::East:         Mu = 0.f;   break;
-		case EWindDirection::South_East:   Mu = 45.f;  break;
-		case EWindDirection::South:        Mu = 90.f;  break;
-		case EWindDirection::South_West:   Mu = 135.f; break;
-		case EWindDirection::West:         Mu = 180.f; break;
-		case EWindDirection::North_West:   Mu = 225.f; break;
-		case EWindDirection::North:        Mu = 270.f; break;
-		case EWindDirection::North_East:   Mu = 315.f; break;
-		case EWindDirection::Random:
-		default:
-			Mu = FMath::RandRange(MinAngle, MaxAngle);
-			break;
+		UE_LOG(LogDropByDropErosion, Error, TEXT("The %dx%d grid is too large to be eroded!"), GridSize.X, GridSize.Y);
+		return false;
 	}
 
-	float FinalAngle = Mu;
+	// With "ErosionCycles" as the upper bound, the adaptive or time-budgeted erosion may stop at the end of any batch.
+	ErosionContext.Convergence = FErosionConvergence();
+	ErosionContext.Convergence.StartTime = FPlatformTime::Seconds();
+	ErosionContext.Workspace.HeightChange = 0.0;
 
-	// Apply Gaussian bias to wind direction if enabled.
-	if (ErosionSettings.bWindBias)
-	{
-		// "Box-Muller" algorithm for Gaussian random number generation.
-		const float First = FMath::FRandRange(0.f + KINDA_SMALL_NUMBER, 1.f);
-		const float Second = FMath::FRandRange(0.f + KINDA_SMALL_NUMBER, 1.f);
-		const float Z = FMath::Sqrt(-2.f * FMath::Loge(First)) * FMath::Cos(2.f * PI * Second);
+	// Kernel specialization is chosen once for the whole simulation.
+	const FSimulateDropsFunction SimulateDropsFunction = GetSimulateDropsFunction(ErosionSettings);
 
-		// Apply "Gaussian distribution" with mean Mu and standard deviation Sigma.
-		FinalAngle = Mu + (Sigma * Z);
+	// The out-of-core erosion pages its own working copy and writes "GridHeights" only once completed.
+	if (ErosionSettings.bOutOfCoreErosion)
+	{
+		const bool bCompleted = ErosionOutOfCore(ErosionContext, ErosionSettings, GridSize, SimulateDropsFunction, Progress);
 
-		// Wrap angle to [0, 360) range.
-		while (FinalAngle < MinAngle)
+		if (Progress)
 		{
-			FinalAngle += MaxAngle;
+			Progress->ElapsedSeconds.store(FPlatformTime::Seconds() - ErosionContext.Convergence.StartTime, std::memory_order_relaxed);
 		}
 
-		while (FinalAngle >= MaxAngle)
+		if (!bCompleted)
 		{
-			FinalAngle -= MaxAngle;
+			UE_LOG(LogDropByDropErosion, Log, TEXT("Out-of-core erosion cancelled or failed."));
+			return false;
 		}
+
+		return true;
 	}
 
-	// Convert angle to radians and create direction vector.
-	const float Rad = FMath::DegreesToRadians(FinalAngle);
-	const float Strength = FMath::RandRange(0.f, 1.f);  // Random strength multiplier.
+	// Apron wide enough for the cell corners and the whole brush.
+	BuildPaddedGrid(ErosionContext, GridSize, Padding, BlockShift);
 
-	return FVector2D(FMath::Cos(Rad), FMath::Sin(Rad)) * Strength;
-}
+	// The brush only changes with the erosion radius and the padded grid row pitch.
+	if (ErosionContext.Brush.Radius != ErosionSettings.ErosionRadius || ErosionContext.Brush.Stride != ErosionContext.Grid.GetRowPitch())
+	{
+		BuildErosionBrush(ErosionContext.Brush, ErosionSettings.ErosionRadius, ErosionContext.Grid.GetRowPitch());
+	}
 
-/**
- * Attempts to get the normalized mean wind angle from erosion settings.
- * Returns false for random wind direction, true otherwise with normalized angle in [0, 360) range.
- */
-bool UErosionLibrary::TryGetWindMeanAngleDegrees(const FErosionSettings& ErosionSettings, float& MeanAngle)
-{
-	float Mu = 0.f;
+	const bool bCompleted = ErosionSettings.bParallelErosion
+		? ErosionParallel(ErosionContext, ErosionSettings, GridSize, SimulateDropsFunction, Progress)
+		: ErosionSerial(ErosionContext, ErosionSettings, GridSize, SimulateDropsFunction, Progress);
 
-	// Map wind direction enum to angle in degrees.
-	switch (ErosionSettings.WindDirection)
+	if (Progress)
 	{
-		case EWindDirection::East:         Mu = 0.f;   break;
-		case EWindDirection::South_East:   Mu = 45.f;  break;
-		case EWindDirection::South:        Mu = 90.f;  break;
-		case EWindDirection::South_West:   Mu = 135.f; break;
-		case EWindDirection::West:         Mu = 180.f; break;
-		case EWindDirection::North_West:   Mu = 225.f; break;
-		case EWindDirection::North:        Mu = 270.f; break;
-		case EWindDirection::North_East:   Mu = 315.f; break;
-		case EWindDirection::Random:
-		default: return false;  // Cannot provide mean for random direction.
+		Progress->ElapsedSeconds.store(FPlatformTime::Seconds() - ErosionContext.Convergence.StartTime, std::memory_order_relaxed);
 	}
 
-	// Normalize angle to [0, 360) range.
-	float Angle = FMath::Fmod(Mu, 360.f);
-	MeanAngle = (Angle < 0.f) ? (Angle + 360.f) : Angle;
+	// A cancelled simulation leaves "GridHeights" untouched.
+	if (!bCompleted)
+	{
+		UE_LOG(LogDropByDropErosion, Log, TEXT("Erosion cancelled."));
+		return false;
+	}
 
+	StitchPaddedGrid(ErosionContext);
+
+	// Erosion simulation complete.
 	return true;
 }
 
 /**
- * Converts a wind angle in degrees to a normalized unit direction vector.
- * Uses standard trigonometric conversion with safe normalization.
+ * On a level downsampled "Levels" times, every step of a drop covers 2^Levels cells of the full grid, so the radius
+ * and the path length are scaled down as much and each coarse drop stands for 4^Levels drops on the same ground:
+ * the coarse share of the erosion cycles is divided accordingly, and the large valleys and fans form for a fraction of the cost.
+ * Only the change made by the coarse pass is upsampled and added, keeping the full-resolution details for the refinement.
+ * Early stops only apply to the refinement, the coarse pass always simulates its whole share.
+ * The progress counts the drops actually simulated by both passes, and once done the drops of the full resolution
+ * they stand for. A refinement stopped early is only closely reproduced from that count, which also shrinks the coarse share.
+ * A cancelled or failed erosion leaves "GridHeights" untouched.
  */
-FVector2D UErosionLibrary::GetWindUnitVectorFromAngle(const float Degrees)
+bool UErosionLibrary::ErosionMultiresolution(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, FErosionProgress* Progress)
 {
-	const float Rad = FMath::DegreesToRadians(Degrees);
+	const double StartTime = FPlatformTime::Seconds();
 
-	const float X = FMath::Cos(Rad);
-	const float Y = FMath::Sin(Rad);
-
-	return FVector2D(X, Y).GetSafeNormal();
-}
+	// Sizes of the levels of the pyramid, only the coarsest one is kept.
+	TArray<FIntPoint> LevelSizes;
+	LevelSizes.Add(GridSize);
 
-/**
- * Applies erosion effects for a single water drop simulation.
- * Simulates drop movement, sediment transport, erosion and deposition over multiple cycles.
- * Uses particle-based hydraulic erosion algorithm.
- */
-void UErosionLibrary::ApplyErosion(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, FDrop& Drop, const int32 GridSize)
-{
-	float Sediment = 0;  // Amount of sediment currently carried by the drop.
+	TArray<float> CoarseHeights;
+	TArray<float> NextHeights;
 
-	// Simulate drop movement for specified number of cycles.
-	for (int64 Cycle = 0; Cycle < ErosionSettings.MaxPath; Cycle++)
+	while (LevelSizes.Num() <= ErosionSettings.MultiresolutionLevels)
 	{
-		// 0) Check if drop has left the valid grid area.
-		if (IsOutOfBound(Drop.Position, GridSize))
+		const FIntPoint Size = LevelSizes.Last();
+		if ((Size.X + 1) / 2 < MULTIRESOLUTION_MIN_LEVEL_SIZE || (Size.Y + 1) / 2 < MULTIRESOLUTION_MIN_LEVEL_SIZE)
 		{
-			return;
+			break;
 		}
 
-		// Calculate integer and fractional parts of drop position.
-		const FVector2D TruncatedPosOld = FVector2D(FMath::Floor(Drop.Position.X), FMath::Floor(Drop.Position.Y)); // (x, y)
-		const FVector2D OffsetPosOld = FVector2D(Drop.Position.X - TruncatedPosOld.X, Drop.Position.Y - TruncatedPosOld.Y);
+		LevelSizes.Add(DownsampleHeights(LevelSizes.Num() == 1 ? ErosionContext.GridHeights : CoarseHeights, Size, NextHeights));
+		Swap(CoarseHeights, NextHeights);
+	}
 
-		// 1) Get heights at all four corners of the current cell.
-		FCornersHeights PosOldHeights;
-		SetCornersHeights(ErosionContext, PosOldHeights, TruncatedPosOld, GridSize);
+	const int32 Levels = LevelSizes.Num() - 1;
 
-		// 2) Compute gradient at current position using bilinear interpolation.
-		FVector2D DropGradient = ComputeGradientByInterpolate(
-			OffsetPosOld,
-			PosOldHeights.X1_Y - PosOldHeights.X_Y,
-			PosOldHeights.X1_Y1 - PosOldHeights.X_Y1,
-			PosOldHeights.X_Y1 - PosOldHeights.X_Y,
-			PosOldHeights.X1_Y1 - PosOldHeights.X1_Y
-		);
+	FErosionSettings FineSettings = ErosionSettings;
+	FineSettings.bMultiresolutionErosion = false;
 
-		// 3) Update direction using inertia blending.
-		// Mix previous direction (inertia) with downhill gradient.
-		Drop.Direction = Drop.Direction * ErosionSettings.Inertia - DropGradient * (1 - ErosionSettings.Inertia);
+	if (Levels == 0)
+	{
+		UE_LOG(LogDropByDropErosion, Log, TEXT("The %dx%d grid is too small for the multiresolution erosion, eroding it at full resolution."), GridSize.X, GridSize.Y);
+		return ErosionPass(ErosionContext, FineSettings, GridSize, Progress);
+	}
 
-		// Stop simulation if direction becomes invalid.
-		if (Drop.Direction.SquaredLength() <= 0)
-		{
-			return;
-		}
+	const int32 Scale = 1 << Levels;
+	const int64 CoarseCycles = static_cast<int64>(ErosionSettings.ErosionCycles * FMath::Clamp(ErosionSettings.MultiresolutionCoarseShare, 0.f, 1.f));
 
-		Drop.Direction.Normalize();
+	FErosionSettings CoarseSettings = FineSettings;
+	CoarseSettings.ErosionCycles = CoarseCycles / (Scale * Scale);
+	CoarseSettings.ErosionRadius = FMath::Max(ErosionSettings.ErosionRadius / Scale, 1);
+	CoarseSettings.MaxPath = FMath::Max(ErosionSettings.MaxPath / Scale, 1);
+	CoarseSettings.bAdaptiveErosion = false;
+	CoarseSettings.ErosionTimeBudget = 0.f;
 
-		// 4) Calculate new position by moving in current direction.
-		Drop.Position = Drop.Position + Drop.Direction;
+	// Drops rounded off the coarse share are left to the refinement.
+	const int64 CoarseEquivalentDrops = CoarseSettings.ErosionCycles * Scale * Scale;
+	FineSettings.ErosionCycles = ErosionSettings.ErosionCycles - CoarseEquivalentDrops;
 
-		// Check if new position is still valid.
-		if (IsOutOfBound(Drop.Position, GridSize))
-		{
-			return;
-		}
+	if (Progress)
+	{
+		Progress->TotalDrops.store(CoarseSettings.ErosionCycles + FineSettings.ErosionCycles, std::memory_order_relaxed);
+	}
 
-		// Initialize weights for points within erosion radius.
-		InitWeights(ErosionContext, ErosionSettings, Drop.Position, GridSize);
+	// The coarsest level is kept as it was, to extract the change made by the coarse pass.
+	FErosionContext CoarseContext;
+	SetHeights(CoarseContext, CoarseHeights);
 
-		// 5) Calculate height difference between old and new positions.
-		const float HeightPosOld = GetBilinearInterpolation(OffsetPosOld, PosOldHeights);
+	if (!ErosionPass(CoarseContext, CoarseSettings, LevelSizes.Last(), Progress))
+	{
+		return false;
+	}
 
-		const FVector2D TruncatedPosNew = FVector2D(FMath::Floor(Drop.Position.X), FMath::Floor(Drop.Position.Y));
-		const FVector2D OffsetPosNew = FVector2D(Drop.Position.X - TruncatedPosNew.X, Drop.Position.Y - TruncatedPosNew.Y);
+	TArray<float> Delta = TakeHeights(CoarseContext);
+	for (int32 Index = 0; Index < Delta.Num(); Index++)
+	{
+		Delta[Index] -= CoarseHeights[Index];
+	}
 
-		FCornersHeights PosNewHeights;
-		SetCornersHeights(ErosionContext, PosNewHeights, TruncatedPosNew, GridSize);
+	// Upsampled level by level, the inverse of the pyramid.
+	for (int32 Level = Levels; Level > 0; Level--)
+	{
+		UpsampleHeights(Delta, LevelSizes[Level], LevelSizes[Level - 1], NextHeights);
+		Swap(Delta, NextHeights);
+	}
 
-		const float HeightPosNew = GetBilinearInterpolation(OffsetPosNew, PosNewHeights);
-		const float HeightsDifference = HeightPosNew - HeightPosOld;
+	// The coarsely eroded heights are built in place of the delta, which then keeps the original heights until the refinement succeeds.
+	TArray<float>& GridHeights = ErosionContext.GridHeights;
+	for (int32 Index = 0; Index < GridHeights.Num(); Index++)
+	{
+		Delta[Index] = FMath::Max(GridHeights[Index] + Delta[Index], 0.f);
+	}
 
-		// 6) Determine whether to deposit or erode sediment.
+	Swap(GridHeights, Delta);
+	TArray<float>& OriginalHeights = Delta;
 
-		// Calculate sediment carrying capacity based on slope, velocity, and water.
-		const float C = FMath::Max(-HeightsDifference, ErosionSettings.MinimalSlope) * Drop.Velocity * Drop.Water * ErosionSettings.Capacity;
+	const double CoarseSeconds = FPlatformTime::Seconds() - StartTime;
 
-		const bool bDropHasMovingUp = HeightsDifference > 0;
-		const bool bDropHasToDeposit = Sediment > C;
+	// Refinement with the rest of the erosion cycles, early stops included.
+	const bool bCompleted = ErosionPass(ErosionContext, FineSettings, GridSize, Progress);
 
-		// Deposit sediment if moving uphill or carrying too much.
-		if (bDropHasMovingUp || bDropHasToDeposit)
-		{
-			// Calculate deposit amount.
-			float Deposit = bDropHasMovingUp ? FMath::Min(HeightsDifference, Sediment) : (Sediment - C) * ErosionSettings.DepositionSpeed;
-			Sediment -= Deposit;
+	if (!bCompleted)
+	{
+		Swap(GridHeights, OriginalHeights);
+	}
 
-			// Distribute deposit across nearby cells.
-			ComputeDepositOnPoints(ErosionContext, TruncatedPosOld, OffsetPosOld, Deposit, GridSize);
-		}
-		else
+	UE_LOG(LogDropByDropErosion, Log, TEXT("Multiresolution erosion: %lld drops on %dx%d in %.2f s, refined on %dx%d in %.2f s."), CoarseSettings.ErosionCycles, LevelSizes.Last().X, LevelSizes.Last().Y, CoarseSeconds, GridSize.X, GridSize.Y, FPlatformTime::Seconds() - StartTime - CoarseSeconds);
+
+	// Both passes reported in drops of the full resolution, the count the same settings reproduce the erosion with.
+	if (Progress)
+	{
+		const int64 SimulatedDrops = CoarseEquivalentDrops + Progress->SimulatedDrops.load(std::memory_order_relaxed) - CoarseSettings.ErosionCycles;
+		Progress->TotalDrops.store(ErosionSettings.ErosionCycles, std::memory_order_relaxed);
+		Progress->SimulatedDrops.store(SimulatedDrops, std::memory_order_relaxed);
+		Progress->ElapsedSeconds.store(FPlatformTime::Seconds() - StartTime, std::memory_order_relaxed);
+	}
+
+	return bCompleted;
+}
+
+/**
+ * Cells of the last row and column of an odd-sized grid are averaged with themselves.
+ */
+FIntPoint UErosionLibrary::DownsampleHeights(const TArray<float>& Heights, const FIntPoint& Size, TArray<float>& OutHeights)
+{
+	const FIntPoint OutSize((Size.X + 1) / 2, (Size.Y + 1) / 2);
+	OutHeights.SetNumUninitialized(OutSize.X * OutSize.Y);
+
+	ParallelFor(OutSize.Y, [&](const int32 Y)
 		{
-			// Erode terrain and pick up sediment.
-			float Erosion = FMath::Min((C - Sediment) * ErosionSettings.ErosionSpeed, -HeightsDifference);
+			const int32 Y0 = 2 * Y;
+			const int32 Y1 = FMath::Min(Y0 + 1, Size.Y - 1);
 
-			// Apply erosion to all points within radius.
-			TArray<float> ErosionValues = GetErosionOnPoints(ErosionContext, Erosion);
-			for (int32 Index = 0; Index < ErosionValues.Num(); Index++)
+			for (int32 X = 0; X < OutSize.X; X++)
 			{
-				const int32 MapIndex = ErosionContext.Points[Index].X + ErosionContext.Points[Index].Y * GridSize;
-
-				// Ensure we don't erode below zero height.
-				const float DeltaSediment = ErosionContext.GridHeights[MapIndex] < ErosionValues[Index] ? ErosionContext.GridHeights[MapIndex] : ErosionValues[Index];
+				const int32 X0 = 2 * X;
+				const int32 X1 = FMath::Min(X0 + 1, Size.X - 1);
 
-				ErosionContext.GridHeights[MapIndex] -= DeltaSediment;
-				Sediment += DeltaSediment;
+				OutHeights[X + Y * OutSize.X] = 0.25f * (Heights[X0 + Y0 * Size.X] + Heights[X1 + Y0 * Size.X] + Heights[X0 + Y1 * Size.X] + Heights[X1 + Y1 * Size.X]);
 			}
-		}
-
-		// 7) Update drop's physical properties.
-		// Calculate new velocity.
-		const float Velocity = ((Drop.Velocity * Drop.Velocity) + (-HeightsDifference) * ErosionSettings.Gravity);
-		Drop.Velocity = Velocity > 0 ? FMath::Sqrt(Velocity) : 0;
+		});
 
-		// Simulate water evaporation.
-		Drop.Water = Drop.Water * (1 - ErosionSettings.Evaporation);
-	}
+	return OutSize;
 }
 
 /**
- * Initializes weight values for cells within the erosion radius of the drop.
- * Calculates normalized weights based on distance from drop position.
+ * Every cell of the upsampled grid is interpolated at its centre, which lies a quarter of a coarse cell
+ * away from the centre of the coarse cell it was averaged into.
  */
-void UErosionLibrary::InitWeights(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FVector2D& DropPosition, const int32 GridSize)
+void UErosionLibrary::UpsampleHeights(const TArray<float>& Heights, const FIntPoint& Size, const FIntPoint& OutSize, TArray<float>& OutHeights)
 {
-	// Clear previous weights and points.
-	ErosionContext.SquaredWeights.Reset();
-	ErosionContext.Points.Reset();
+	OutHeights.SetNumUninitialized(OutSize.X * OutSize.Y);
 
-	float RelativeSquaredWeightsSum = 0;
-	TArray<float> RelativeSquaredWeights;
+	ParallelFor(OutSize.Y, [&](const int32 Y)
+		{
+			const float V = FMath::Clamp(0.5f * Y - 0.25f, 0.f, Size.Y - 1.f);
+			const int32 Y0 = FMath::FloorToInt32(V);
+			const int32 Y1 = FMath::Min(Y0 + 1, Size.Y - 1);
+			const float OffsetY = V - Y0;
 
-	// Identify all points within erosion radius.
-	SetInRadiusPoints(ErosionContext, ErosionSettings, DropPosition, GridSize);
+			for (int32 X = 0; X < OutSize.X; X++)
+			{
+				const float U = FMath::Clamp(0.5f * X - 0.25f, 0.f, Size.X - 1.f);
+				const int32 X0 = FMath::FloorToInt32(U);
+				const int32 X1 = FMath::Min(X0 + 1, Size.X - 1);
+				const float OffsetX = U - X0;
 
-	// Calculate raw weights and their sum.
-	for (int32 Index = 0; Index < ErosionContext.Points.Num(); Index++)
-	{
-		RelativeSquaredWeights.Add(GetRelativeWeightOnPoint(ErosionSettings, DropPosition, ErosionContext.Points[Index]));
-		RelativeSquaredWeightsSum += RelativeSquaredWeights[Index];
-	}
+				const float Top = FMath::Lerp(Heights[X0 + Y0 * Size.X], Heights[X1 + Y0 * Size.X], OffsetX);
+				const float Bottom = FMath::Lerp(Heights[X0 + Y1 * Size.X], Heights[X1 + Y1 * Size.X], OffsetX);
 
-	// Normalize weights so they sum to "1.0".
-	for (int32 Index = 0; Index < ErosionContext.Points.Num(); Index++)
-	{
-		ErosionContext.SquaredWeights.Add(GetRelativeWeightOnPoint(ErosionSettings, DropPosition, ErosionContext.Points[Index]) / RelativeSquaredWeightsSum);
-	}
+				OutHeights[X + Y * OutSize.X] = FMath::Lerp(Top, Bottom, OffsetY);
+			}
+		});
 }
 
+#pragma region Benchmark
+
+static FAutoConsoleCommand BenchmarkErosionCommand(
+	TEXT("DropByDrop.BenchmarkErosion"),
+	TEXT("Times the erosion of synthetic 1k, 2k and 4k heightmaps with the row-major and the blocked grid layouts. Usage: DropByDrop.BenchmarkErosion [Drops]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&UErosionLibrary::BenchmarkErosion));
+
 /**
- * Main erosion simulation entry point.
- * Simulates multiple water drops to erode the landscape over many iterations.
+ * Runs the same serial erosion (same seed, same drops) on every heightmap size and grid layout,
+ * logging the wall time, including the layout conversions, and the drops simulated per second.
+ * Cache miss rates are not measured here, run the command under a hardware profiler to get them.
  */
-void UErosionLibrary::Erosion(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const int32 GridSize)
+void UErosionLibrary::BenchmarkErosion(const TArray<FString>& Args)
 {
-	// Pre-allocate memory for points and weights based on erosion radius.
-	const int32 SampledPointsInRadius = (2 * ErosionSettings.ErosionRadius + 1) * (2 * ErosionSettings.ErosionRadius + 1);
-	ErosionContext.SquaredWeights.Reserve(SampledPointsInRadius);
-	ErosionContext.Points.Reserve(SampledPointsInRadius);
+	const int64 NumDrops = Args.Num() > 0 ? FMath::Max<int64>(FCString::Atoi64(*Args[0]), 1) : EROSION_BENCHMARK_DROPS;
 
-	// Simulate multiple drops for specified number of erosion cycles.
-	for (int64 Index = 0; Index < ErosionSettings.ErosionCycles; Index++)
+	// Valid landscape resolutions close to 1k, 2k and 4k, row-major first.
+	const int32 Sizes[] = { 1009, 2017, 4033 };
+	const int32 BlockSizes[] = { 0, 8, 16 };
+
+	for (const int32 Size : Sizes)
 	{
-		FDrop Drop;
-		InitDrop(ErosionSettings, Drop, GridSize);
-		ApplyErosion(ErosionContext, ErosionSettings, Drop, GridSize);
+		// Rolling terrain with some detail, so drops travel and erode like on a real heightmap.
+		TArray<float> Heights;
+		Heights.SetNumUninitialized(Size * Size);
+
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				const FVector2D Location(X, Y);
+				Heights[X + Y * Size] = 0.5f + 0.35f * FMath::PerlinNoise2D(Location * 0.004) + 0.1f * FMath::PerlinNoise2D(Location * 0.03);
+			}
+		}
+
+		for (const int32 BlockSize : BlockSizes)
+		{
+			FErosionSettings ErosionSettings;
+			ErosionSettings.ErosionCycles = NumDrops;
+			ErosionSettings.GridBlockSize = BlockSize;
+
+			FErosionContext ErosionContext;
+			SetHeights(ErosionContext, Heights);
 
-		// Drop completes its lifecycle.
+			const double StartTime = FPlatformTime::Seconds();
+			Erosion(ErosionContext, ErosionSettings, FIntPoint(Size, Size));
+			const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+			const FString Layout = BlockSize > 1 ? FString::Printf(TEXT("%dx%d blocks"), BlockSize, BlockSize) : TEXT("rows");
+			UE_LOG(LogDropByDropErosion, Display, TEXT("Erosion benchmark: %dx%d, %s, %lld drops in %.3f s (%.0f drops/s)."), Size, Size, *Layout, NumDrops, ElapsedTime, NumDrops / FMath::Max(ElapsedTime, UE_DOUBLE_SMALL_NUMBER));
+		}
 	}
+}
 
-	// Erosion simulation complete.
-}
\ No newline at end of file
+#pragma endregion
\ No newline at end of file
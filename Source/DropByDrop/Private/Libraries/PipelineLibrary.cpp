@@ -15,54 +15,86 @@
 #include "Misc/ScopedSlowTask.h"
 #include "UObject/SavePackage.h"
 #include "LandscapeSubsystem.h"
+#include "ScopedTransaction.h"
 #include "DropByDropLogger.h"
+#include "LandscapeEdit.h"
+#include "LandscapeInfo.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "IImageWrapperModule.h"
+#include "IImageWrapper.h"
+#include "Async/ParallelFor.h"
+#include "Async/Async.h"
 #include "ImageUtils.h"
+#include "Tasks/Task.h"
 #include "Landscape.h"
 
 #define EMPTY_STRING ""
 #define HEIGHTMAP_PATH_SUFFIX "Saved/HeightMap/raw.r16" 
 #define HEIGHTMAP_ASSET_PREFIX "/DropByDrop/SavedAssets"
 
-#define STANDARD_HEIGHTMAP_SIZE 505
+// Section layout of the landscape editor, the starting point of the component size search for sizes without an exact layout.
+#define LANDSCAPE_DEFAULT_SUBSECTION_SIZE_QUADS 63
+#define LANDSCAPE_DEFAULT_NUM_SUBSECTIONS 1
 
-TArray<uint16> UPipelineLibrary::StandardizeHeightmapResolution(const TArray<uint16>& SourceHeightmap)
+// Largest side, in cells, of the heightmap eroded by the erosion preview.
+#define EROSION_PREVIEW_SIZE 128
+
+// Drops simulated by the erosion preview: about one per cell, eroded in a few tens of milliseconds.
+#define EROSION_PREVIEW_DROPS 16384
+
+// Samples per side of the grid estimating the normalization bounds of a heightmap generated in tiles.
+#define HEIGHTMAP_BOUNDS_SAMPLES 257
+
+// Fraction of the sampled range added on both sides of the estimated bounds, for the peaks between samples.
+#define HEIGHTMAP_BOUNDS_MARGIN 0.05f
+
+// Heights generated at once when a heightmap is streamed to a file (32 MB of floats).
+#define HEIGHTMAP_STREAM_BAND_BYTES (32 * 1024 * 1024)
+
+// Appended to the path of a non-square RAW heightmap to name the file holding its "Width Height".
+#define RAW_HEIGHTMAP_SIZE_SUFFIX ".size"
+
+TArray<uint16> UPipelineLibrary::StandardizeHeightmapResolution(TArray<uint16>&& SourceHeightmap, const FIntPoint& SourceSize, FIntPoint& OutSize)
 {
-	// Validate input is not empty.
-	if (SourceHeightmap.Num() <= 0)
+	// Validate input is not empty and matches its dimensions.
+	if (SourceHeightmap.Num() <= 0 || SourceHeightmap.Num() != static_cast<int64>(SourceSize.X) * SourceSize.Y)
 	{
-		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Cannot standardize empty heightmap!"));
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Cannot standardize an empty or malformed heightmap!"));
 		return TArray<uint16>();
 	}
 
-	// Calculate original heightmap dimensions (assumes square layout).
-	const int32 SourceSize = static_cast<int32>(FMath::Sqrt(static_cast<float>(SourceHeightmap.Num())));
+	OutSize = GetLandscapeResolution(SourceSize);
 
-	// If already at standard resolution, return copy.
-	if (SourceSize == STANDARD_HEIGHTMAP_SIZE)
+	// If already at a valid landscape resolution, hand the source over.
+	if (OutSize == SourceSize)
 	{
-		return SourceHeightmap;
+		return MoveTemp(SourceHeightmap);
 	}
 
-	// Pre-allocate output heightmap at standard resolution.
+	UE_LOG(LogDropByDropHeightmap, Log, TEXT("Resampling the %dx%d heightmap to %dx%d to fit the landscape components."), SourceSize.X, SourceSize.Y, OutSize.X, OutSize.Y);
+
+	// Pre-allocate output heightmap at landscape resolution.
 	TArray<uint16> StandardizedHeightmap;
-	StandardizedHeightmap.SetNum(STANDARD_HEIGHTMAP_SIZE * STANDARD_HEIGHTMAP_SIZE);
+	StandardizedHeightmap.SetNumUninitialized(OutSize.X * OutSize.Y);
 
 	// Bilinear interpolation resampling loop.
 	// Maps each output pixel to its corresponding location in source space.
-	for (int32 Height = 0; Height < STANDARD_HEIGHTMAP_SIZE; Height++)
+	for (int32 Height = 0; Height < OutSize.Y; Height++)
 	{
-		for (int32 Width = 0; Width < STANDARD_HEIGHTMAP_SIZE; Width++)
+		for (int32 Width = 0; Width < OutSize.X; Width++)
 		{
-			// Map output coordinates (0 - 505) to source coordinates (0 - SourceSize).
+			// Map output coordinates (0 - OutSize) to source coordinates (0 - SourceSize).
 			// Normalized to [0, 1] then scaled to source dimensions.
-			float SourceX = (Width / static_cast<float>(STANDARD_HEIGHTMAP_SIZE - 1)) * (SourceSize - 1);
-			float SourceY = (Height / static_cast<float>(STANDARD_HEIGHTMAP_SIZE - 1)) * (SourceSize - 1);
+			float SourceX = (Width / static_cast<float>(FMath::Max(OutSize.X - 1, 1))) * (SourceSize.X - 1);
+			float SourceY = (Height / static_cast<float>(FMath::Max(OutSize.Y - 1, 1))) * (SourceSize.Y - 1);
 
 			// Extract integer and fractional parts for interpolation.
 			int32 X0 = static_cast<int32>(SourceX);
 			int32 Y0 = static_cast<int32>(SourceY);
-			int32 X1 = FMath::Min(X0 + 1, SourceSize - 1);
-			int32 Y1 = FMath::Min(Y0 + 1, SourceSize - 1);
+			int32 X1 = FMath::Min(X0 + 1, SourceSize.X - 1);
+			int32 Y1 = FMath::Min(Y0 + 1, SourceSize.Y - 1);
 
 			// Fractional components used for interpolation weights.
 			float FracX = SourceX - X0;
@@ -70,10 +102,10 @@ TArray<uint16> UPipelineLibrary::StandardizeHeightmapResolution(const TArray<uin
 
 			// Sample the 4 surrounding pixels from source heightmap.
 			// Layout: Y0/Y1 rows, X0/X1 columns.
-			uint16 V00 = SourceHeightmap[Y0 * SourceSize + X0];
-			uint16 V10 = SourceHeightmap[Y0 * SourceSize + X1];
-			uint16 V01 = SourceHeightmap[Y1 * SourceSize + X0];
-			uint16 V11 = SourceHeightmap[Y1 * SourceSize + X1];
+			uint16 V00 = SourceHeightmap[Y0 * SourceSize.X + X0];
+			uint16 V10 = SourceHeightmap[Y0 * SourceSize.X + X1];
+			uint16 V01 = SourceHeightmap[Y1 * SourceSize.X + X0];
+			uint16 V11 = SourceHeightmap[Y1 * SourceSize.X + X1];
 
 			// Bilinear interpolation: first interpolate horizontally on both rows.
 			float V0 = FMath::Lerp(static_cast<float>(V00), static_cast<float>(V10), FracX);
@@ -83,7 +115,7 @@ TArray<uint16> UPipelineLibrary::StandardizeHeightmapResolution(const TArray<uin
 			float FinalValue = FMath::Lerp(V0, V1, FracY);
 
 			// Write to output heightmap with bounds checking.
-			const int32 DestIndex = Height * STANDARD_HEIGHTMAP_SIZE + Width;
+			const int32 DestIndex = Height * OutSize.X + Width;
 			StandardizedHeightmap[DestIndex] = static_cast<uint16>(FMath::Clamp(FinalValue, 0.f, 65535.f));
 		}
 	}
@@ -91,6 +123,24 @@ TArray<uint16> UPipelineLibrary::StandardizeHeightmapResolution(const TArray<uin
 	return StandardizedHeightmap;
 }
 
+/**
+ * Asks the landscape import helper for the component layout covering the heightmap
+ * and returns the resulting number of vertices per side.
+ */
+FIntPoint UPipelineLibrary::GetLandscapeResolution(const FIntPoint& HeightmapSize)
+{
+	// Read by the import helper when no component layout matches the size exactly.
+	int32 SubSectionSizeQuads = LANDSCAPE_DEFAULT_SUBSECTION_SIZE_QUADS;
+	int32 NumSubsections = LANDSCAPE_DEFAULT_NUM_SUBSECTIONS;
+	FIntPoint ComponentCount;
+
+	FLandscapeImportHelper::ChooseBestComponentSizeForImport(HeightmapSize.X, HeightmapSize.Y, SubSectionSizeQuads, NumSubsections, ComponentCount);
+
+	// Add 1 because vertices = quads + 1.
+	const int32 QuadsPerComponent = NumSubsections * SubSectionSizeQuads;
+	return FIntPoint(ComponentCount.X * QuadsPerComponent + 1, ComponentCount.Y * QuadsPerComponent + 1);
+}
+
 #pragma region Erosion(Templates)
 
 /**
@@ -98,7 +148,7 @@ TArray<uint16> UPipelineLibrary::StandardizeHeightmapResolution(const TArray<uin
  * This function:
  * 1. Validates the landscape and extracts heightmap data.
  * 2. Runs the erosion simulation.
- * 3. Creates a new landscape with the eroded heightmap.
+ * 3. Creates a new landscape with the eroded heightmap, or writes it into the original one.
  * 4. Preserves all settings from the original landscape.
  */
 bool UPipelineLibrary::GenerateErosion(TObjectPtr<ALandscape> ActiveLandscape, FErosionSettings& ErosionSettings)
@@ -111,30 +161,100 @@ bool UPipelineLibrary::GenerateErosion(TObjectPtr<ALandscape> ActiveLandscape, F
 		return false;
 	}
 
-	// Take the heightmap.
-	TArray<float> HeightmapFloat = ActiveLandscapeInfoComponent->GetHeightMapSettings().HeightMap;
-	TArray<uint16> HeightmapToErode = ConvertArrayFromFloatToUInt16(HeightmapFloat);
-
 	// Create a progress dialog for long-running erosion operation.
 	FScopedSlowTask SlowTask(100, FText::FromString("Erosion in progress..."));
 	SlowTask.MakeDialog(true);
 
 	// Initialize erosion context with current heightmap data and starts the erosion.
+	// The stored heights already match the landscape, the original stays untouched until the heights are applied.
+	const FHeightMapGenerationSettings& HeightMapSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+
 	FErosionContext ErosionContext;
-	UErosionLibrary::SetHeights(ErosionContext, ConvertArrayFromUInt16ToFloat(HeightmapToErode));
-	UErosionLibrary::Erosion(ErosionContext, ErosionSettings, STANDARD_HEIGHTMAP_SIZE);
+	UErosionLibrary::SetHeights(ErosionContext, HeightMapSettings.HeightMap);
+	if (!UErosionLibrary::Erosion(ErosionContext, ErosionSettings, FIntPoint(HeightMapSettings.SizeX, HeightMapSettings.SizeY)))
+	{
+		return false;
+	}
 
 	SlowTask.EnterProgressFrame(50, FText::FromString("Applying on the landscape..."));
 
+	return ApplyErodedHeights(ActiveLandscape, UErosionLibrary::TakeHeights(ErosionContext), ErosionSettings.bApplyInPlace);
+}
+
+/**
+ * Runs the erosion simulation on a background task.
+ * The task works on copies of the heightmap and of the settings, so the editor stays responsive
+ * and the panel can keep being edited; the eroded landscape is then created on the game thread,
+ * provided the source landscape still exists and the simulation was not cancelled.
+ */
+bool UPipelineLibrary::GenerateErosionAsync(TObjectPtr<ALandscape> ActiveLandscape, const FErosionSettings& ErosionSettings, const TSharedRef<FErosionProgress>& Progress, TFunction<void(bool)> OnCompleted)
+{
+	check(IsInGameThread());
+
+	// Retrieve the landscape info component which stores heightmap and generation settings.
+	ULandscapeInfoComponent* ActiveLandscapeInfoComponent = IsValid(ActiveLandscape) ? ActiveLandscape->FindComponentByClass<ULandscapeInfoComponent>() : nullptr;
+	if (!ActiveLandscapeInfoComponent)
+	{
+		UE_LOG(LogDropByDropLandscape, Error, TEXT("The \"Active Landscape\" resource is invalid!"));
+		return false;
+	}
+
+	// Take the heightmap, the only copy made for the task: it then moves along until it is applied.
+	const FHeightMapGenerationSettings& HeightMapSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+	TArray<float> HeightmapToErode = HeightMapSettings.HeightMap;
+	const FIntPoint GridSize(HeightMapSettings.SizeX, HeightMapSettings.SizeY);
+	TWeakObjectPtr<ALandscape> WeakLandscape = ActiveLandscape.Get();
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		[HeightmapToErode = MoveTemp(HeightmapToErode), GridSize, ErosionSettings, Progress, WeakLandscape, OnCompleted = MoveTemp(OnCompleted)]() mutable
+		{
+			FErosionContext ErosionContext;
+			UErosionLibrary::SetHeights(ErosionContext, MoveTemp(HeightmapToErode));
+
+			const bool bEroded = UErosionLibrary::Erosion(ErosionContext, ErosionSettings, GridSize, &Progress.Get());
+			TArray<float> ErodedHeights = bEroded ? UErosionLibrary::TakeHeights(ErosionContext) : TArray<float>();
+
+			// Landscapes can only be spawned and edited on the game thread.
+			AsyncTask(ENamedThreads::GameThread, [bEroded, bApplyInPlace = ErosionSettings.bApplyInPlace, ErodedHeights = MoveTemp(ErodedHeights), WeakLandscape, OnCompleted = MoveTemp(OnCompleted)]() mutable
+				{
+					// The source landscape may have been deleted while eroding.
+					const bool bCreated = bEroded && WeakLandscape.IsValid() && ApplyErodedHeights(WeakLandscape.Get(), MoveTemp(ErodedHeights), bApplyInPlace);
+
+					if (OnCompleted)
+					{
+						OnCompleted(bCreated);
+					}
+				});
+		},
+		UE::Tasks::ETaskPriority::BackgroundNormal);
+
+	return true;
+}
+
+/**
+ * Spawns the eroded copy of a landscape and carries over the settings of the original,
+ * marking the new one as eroded.
+ */
+bool UPipelineLibrary::CreateErodedLandscape(ALandscape* ActiveLandscape, TArray<float>&& ErodedHeights)
+{
+	ULandscapeInfoComponent* ActiveLandscapeInfoComponent = ActiveLandscape->FindComponentByClass<ULandscapeInfoComponent>();
+	if (!ActiveLandscapeInfoComponent)
+	{
+		UE_LOG(LogDropByDropLandscape, Error, TEXT("The \"Active Landscape\" resource is invalid!"));
+		return false;
+	}
+
 	// Convert eroded heightmap from normalized float to 16-bit unsigned integer format required by Unreal.
-	TArray<uint16> ErodedHeightmapU16 = ConvertArrayFromFloatToUInt16(UErosionLibrary::GetHeights(ErosionContext));
+	// This is the only quantization of the eroded heights.
+	TArray<uint16> ErodedHeightmapU16 = ConvertArrayFromFloatToUInt16(ErodedHeights);
 
-	const FTransform LandscapeTransform = GetNewTransform(ActiveLandscapeInfoComponent->GetExternalSettings(), ActiveLandscapeInfoComponent->GetLandscapeSettings(), STANDARD_HEIGHTMAP_SIZE);
+	const FHeightMapGenerationSettings& SourceHeightMapSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+	const FIntPoint HeightmapSize(SourceHeightMapSettings.SizeX, SourceHeightMapSettings.SizeY);
 
-	SlowTask.EnterProgressFrame(50);
+	const FTransform LandscapeTransform = GetNewTransform(ActiveLandscapeInfoComponent->GetExternalSettings(), ActiveLandscapeInfoComponent->GetLandscapeSettings(), HeightmapSize);
 
 	// Spawn the new landscape with the eroded heightmap.
-	TObjectPtr<ALandscape> NewLandscape = GenerateLandscape(LandscapeTransform, ErodedHeightmapU16);
+	TObjectPtr<ALandscape> NewLandscape = GenerateLandscape(LandscapeTransform, MoveTemp(ErodedHeightmapU16), HeightmapSize);
 
 	if (!IsValid(NewLandscape))
 	{
@@ -154,11 +274,16 @@ bool UPipelineLibrary::GenerateErosion(TObjectPtr<ALandscape> ActiveLandscape, F
 	ErodedLandscapeInfoComponent->SetIsEroded(true);
 	ErodedLandscapeInfoComponent->SetExternalSettings(ActiveLandscapeInfoComponent->GetExternalSettings());
 
-	FHeightMapGenerationSettings ErodedSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
-	ErodedSettings.Size = STANDARD_HEIGHTMAP_SIZE;
-	ErodedSettings.HeightMap = ConvertArrayFromUInt16ToFloat(ErodedHeightmapU16);
+	// Copy the generation settings but not the source heights, the eroded ones are moved in instead.
+	FHeightMapGenerationSettings& SourceSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+	FHeightMapGenerationSettings& ErodedSettings = ErodedLandscapeInfoComponent->GetHeightMapSettings();
+
+	TArray<float> SourceHeights = MoveTemp(SourceSettings.HeightMap);
+	ErodedSettings = SourceSettings;
+	SourceSettings.HeightMap = MoveTemp(SourceHeights);
+
+	ErodedSettings.HeightMap = MoveTemp(ErodedHeights);
 
-	ErodedLandscapeInfoComponent->SetHeightMapSettings(ErodedSettings);
 	ErodedLandscapeInfoComponent->SetLandscapeSettings(ActiveLandscapeInfoComponent->GetLandscapeSettings());
 
 	// UE_LOG(LogDropByDropLandscape, Log, TEXT("Landscape generated successfully after erosion!"));
@@ -166,16 +291,273 @@ bool UPipelineLibrary::GenerateErosion(TObjectPtr<ALandscape> ActiveLandscape, F
 	return true;
 }
 
+/**
+ * Writes the eroded heights into the existing landscape through "FLandscapeEditDataInterface".
+ * The heightmap is compared one landscape component at a time against the stored one,
+ * and only the components with at least one changed vertex are written, so neither a reimport
+ * nor a new split into proxies is needed. The edit can be undone as a single transaction.
+ */
+bool UPipelineLibrary::ApplyErodedHeightsInPlace(ALandscape* ActiveLandscape, TArray<float>&& ErodedHeights)
+{
+	ULandscapeInfoComponent* ActiveLandscapeInfoComponent = ActiveLandscape->FindComponentByClass<ULandscapeInfoComponent>();
+	ULandscapeInfo* LandscapeInfo = ActiveLandscape->GetLandscapeInfo();
+	if (!ActiveLandscapeInfoComponent || !LandscapeInfo)
+	{
+		UE_LOG(LogDropByDropLandscape, Error, TEXT("The \"Active Landscape\" resource is invalid!"));
+		return false;
+	}
+
+	FHeightMapGenerationSettings& HeightMapSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+	const FIntPoint HeightmapSize(HeightMapSettings.SizeX, HeightMapSettings.SizeY);
+
+	// The eroded heightmap must cover the whole landscape, vertex by vertex.
+	int32 MinX, MinY, MaxX, MaxY;
+	if (!LandscapeInfo->GetLandscapeExtent(MinX, MinY, MaxX, MaxY) || MaxX - MinX + 1 != HeightmapSize.X || MaxY - MinY + 1 != HeightmapSize.Y || ErodedHeights.Num() != HeightmapSize.X * HeightmapSize.Y)
+	{
+		UE_LOG(LogDropByDropLandscape, Error, TEXT("The landscape does not match the %dx%d eroded heightmap!"), HeightmapSize.X, HeightmapSize.Y);
+		return false;
+	}
+
+	// Single quantization of the eroded heights, for the landscape only.
+	const TArray<uint16> ErodedHeightmapU16 = ConvertArrayFromFloatToUInt16(ErodedHeights);
+
+	// Without a comparable source heightmap, every component is written.
+	const bool bCanCompare = HeightMapSettings.HeightMap.Num() == ErodedHeights.Num();
+
+	FScopedTransaction Transaction(FText::FromString("Erode Landscape"));
+	ActiveLandscapeInfoComponent->Modify();
+
+	int32 ChangedComponents = 0;
+	{
+		// Heights go into the base edit layer, the layers are then recomposited once.
+		const FGuid EditLayerGuid = ActiveLandscape->HasLayersContent() ? ActiveLandscape->GetLayer(0)->Guid : FGuid();
+		FScopedSetLandscapeEditingLayer EditingLayer(ActiveLandscape, EditLayerGuid, [ActiveLandscape]()
+			{
+				ActiveLandscape->RequestLayersContentUpdate(ELandscapeLayerUpdateMode::Update_Heightmap_All);
+			});
+
+		FLandscapeEditDataInterface LandscapeEdit(LandscapeInfo);
+
+		const int32 ComponentSizeQuads = LandscapeInfo->ComponentSizeQuads;
+		const FIntPoint ComponentCount((HeightmapSize.X - 1) / ComponentSizeQuads, (HeightmapSize.Y - 1) / ComponentSizeQuads);
+
+		for (int32 ComponentY = 0; ComponentY < ComponentCount.Y; ComponentY++)
+		{
+			for (int32 ComponentX = 0; ComponentX < ComponentCount.X; ComponentX++)
+			{
+				// Vertices of the component (inclusive), borders shared with the neighbours.
+				const int32 X1 = ComponentX * ComponentSizeQuads;
+				const int32 Y1 = ComponentY * ComponentSizeQuads;
+				const int32 X2 = X1 + ComponentSizeQuads;
+				const int32 Y2 = Y1 + ComponentSizeQuads;
+
+				bool bChanged = !bCanCompare;
+				for (int32 Y = Y1; Y <= Y2 && !bChanged; Y++)
+				{
+					const int32 RowStart = Y * HeightmapSize.X + X1;
+					bChanged = FMemory::Memcmp(HeightMapSettings.HeightMap.GetData() + RowStart, ErodedHeights.GetData() + RowStart, (X2 - X1 + 1) * sizeof(float)) != 0;
+				}
+
+				if (!bChanged)
+				{
+					continue;
+				}
+
+				LandscapeEdit.SetHeightData(MinX + X1, MinY + Y1, MinX + X2, MinY + Y2, ErodedHeightmapU16.GetData() + Y1 * HeightmapSize.X + X1, HeightmapSize.X, true);
+				ChangedComponents++;
+			}
+		}
+
+		LandscapeEdit.Flush();
+	}
+
+	// Keep the stored heightmap in sync, the next erosion starts from these heights.
+	HeightMapSettings.HeightMap = MoveTemp(ErodedHeights);
+
+	ActiveLandscapeInfoComponent->SetIsEroded(true);
+
+	UE_LOG(LogDropByDropLandscape, Log, TEXT("Eroded heights applied in place on %d landscape components."), ChangedComponents);
+
+	return true;
+}
+
+/**
+ * Every preview cell averages the block of heightmap cells it covers, keeping the aspect ratio of the heightmap.
+ */
+bool UPipelineLibrary::CreateErosionPreviewHeights(const ALandscape* ActiveLandscape, TArray<float>& OutHeights, FIntPoint& OutSize)
+{
+	const ULandscapeInfoComponent* ActiveLandscapeInfoComponent = IsValid(ActiveLandscape) ? ActiveLandscape->FindComponentByClass<ULandscapeInfoComponent>() : nullptr;
+	if (!ActiveLandscapeInfoComponent)
+	{
+		return false;
+	}
+
+	const FHeightMapGenerationSettings& HeightMapSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+	const FIntPoint SourceSize(HeightMapSettings.SizeX, HeightMapSettings.SizeY);
+	if (SourceSize.X <= 0 || SourceSize.Y <= 0 || HeightMapSettings.HeightMap.Num() != static_cast<int64>(SourceSize.X) * SourceSize.Y)
+	{
+		return false;
+	}
+
+	const float Scale = FMath::Min(static_cast<float>(EROSION_PREVIEW_SIZE) / SourceSize.GetMax(), 1.f);
+	OutSize = FIntPoint(FMath::Max(FMath::RoundToInt32(SourceSize.X * Scale), 2), FMath::Max(FMath::RoundToInt32(SourceSize.Y * Scale), 2));
+	OutHeights.SetNumUninitialized(OutSize.X * OutSize.Y);
+
+	for (int32 Y = 0; Y < OutSize.Y; Y++)
+	{
+		const int32 MinY = static_cast<int64>(Y) * SourceSize.Y / OutSize.Y;
+		const int32 MaxY = FMath::Max(static_cast<int32>(static_cast<int64>(Y + 1) * SourceSize.Y / OutSize.Y), MinY + 1);
+
+		for (int32 X = 0; X < OutSize.X; X++)
+		{
+			const int32 MinX = static_cast<int64>(X) * SourceSize.X / OutSize.X;
+			const int32 MaxX = FMath::Max(static_cast<int32>(static_cast<int64>(X + 1) * SourceSize.X / OutSize.X), MinX + 1);
+
+			float Sum = 0.f;
+			for (int32 SourceY = MinY; SourceY < MaxY; SourceY++)
+			{
+				for (int32 SourceX = MinX; SourceX < MaxX; SourceX++)
+				{
+					Sum += HeightMapSettings.HeightMap[SourceX + SourceY * SourceSize.X];
+				}
+			}
+
+			OutHeights[X + Y * OutSize.X] = Sum / ((MaxX - MinX) * (MaxY - MinY));
+		}
+	}
+
+	return true;
+}
+
+/**
+ * The preview always simulates "EROSION_PREVIEW_DROPS" drops on the calling task, whatever the erosion cycles
+ * and the performance options, so its latency only depends on the physical parameters being tuned.
+ */
+void UPipelineLibrary::GenerateErosionPreviewAsync(const TArray<float>& PreviewHeights, const FIntPoint& PreviewSize, const FErosionSettings& ErosionSettings, const TSharedRef<FErosionProgress>& Progress, TFunction<void(TArray<FColor>&&)> OnCompleted)
+{
+	FErosionSettings PreviewSettings = ErosionSettings;
+	PreviewSettings.ErosionCycles = EROSION_PREVIEW_DROPS;
+	PreviewSettings.bAdaptiveErosion = false;
+	PreviewSettings.ErosionTimeBudget = 0.f;
+	PreviewSettings.bParallelErosion = false;
+	PreviewSettings.bMultiresolutionErosion = false;
+	PreviewSettings.bOutOfCoreErosion = false;
+	PreviewSettings.GridBlockSize = 0;
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION,
+		// Copied into a non-const member, which the task then moves into its context.
+		[PreviewHeights = TArray<float>(PreviewHeights), PreviewSize, PreviewSettings, Progress, OnCompleted = MoveTemp(OnCompleted)]() mutable
+		{
+			FErosionContext ErosionContext;
+			UErosionLibrary::SetHeights(ErosionContext, MoveTemp(PreviewHeights));
+
+			if (Progress->IsCancelRequested() || !UErosionLibrary::Erosion(ErosionContext, PreviewSettings, PreviewSize, &Progress.Get()))
+			{
+				return;
+			}
+
+			TArray<FColor> Pixels;
+			ShadeErosionPreview(UErosionLibrary::TakeHeights(ErosionContext), PreviewSize, Pixels);
+
+			AsyncTask(ENamedThreads::GameThread, [Progress, Pixels = MoveTemp(Pixels), OnCompleted = MoveTemp(OnCompleted)]() mutable
+				{
+					// A newer preview may have been requested meanwhile.
+					if (!Progress->IsCancelRequested() && OnCompleted)
+					{
+						OnCompleted(MoveTemp(Pixels));
+					}
+				});
+		},
+		UE::Tasks::ETaskPriority::BackgroundHigh);
+}
+
+/**
+ * Lambert shading of the normals computed by central differences, the heights being stretched to the whole
+ * [0, 1] range first so that flat heightmaps still show their relief. Brightness also grows with the height.
+ */
+void UPipelineLibrary::ShadeErosionPreview(const TArray<float>& Heights, const FIntPoint& Size, TArray<FColor>& OutPixels)
+{
+	float MinHeight = Heights[0];
+	float MaxHeight = Heights[0];
+	for (const float Height : Heights)
+	{
+		MinHeight = FMath::Min(MinHeight, Height);
+		MaxHeight = FMath::Max(MaxHeight, Height);
+	}
+
+	// Slopes in heights per preview width, so the relief looks the same whatever the preview size.
+	const float HeightScale = 1.f / FMath::Max(MaxHeight - MinHeight, UE_SMALL_NUMBER);
+	const float SlopeScale = 0.5f * HeightScale * Size.GetMax();
+	const FVector3f LightDirection = FVector3f(-1.f, -1.f, 1.f).GetSafeNormal();
+
+	OutPixels.SetNumUninitialized(Size.X * Size.Y);
+
+	for (int32 Y = 0; Y < Size.Y; Y++)
+	{
+		const int32 TopY = FMath::Max(Y - 1, 0);
+		const int32 BottomY = FMath::Min(Y + 1, Size.Y - 1);
+
+		for (int32 X = 0; X < Size.X; X++)
+		{
+			const int32 LeftX = FMath::Max(X - 1, 0);
+			const int32 RightX = FMath::Min(X + 1, Size.X - 1);
+
+			const float SlopeX = (Heights[RightX + Y * Size.X] - Heights[LeftX + Y * Size.X]) * SlopeScale / FMath::Max(RightX - LeftX, 1);
+			const float SlopeY = (Heights[X + BottomY * Size.X] - Heights[X + TopY * Size.X]) * SlopeScale / FMath::Max(BottomY - TopY, 1);
+
+			const FVector3f Normal = FVector3f(-SlopeX, -SlopeY, 1.f).GetSafeNormal();
+			const float Light = FMath::Max(FVector3f::DotProduct(Normal, LightDirection), 0.f);
+			const float Height = (Heights[X + Y * Size.X] - MinHeight) * HeightScale;
+
+			const uint8 Value = static_cast<uint8>(FMath::Clamp((0.25f + 0.75f * Light) * (0.6f + 0.4f * Height), 0.f, 1.f) * 255.f);
+			OutPixels[X + Y * Size.X] = FColor(Value, Value, Value, 255);
+		}
+	}
+}
+
+/**
+ * Same layout as "CreateHeightMapTexture", without mips or compression, and collected once released.
+ */
+UTexture2D* UPipelineLibrary::CreateErosionPreviewTexture(const TArray<FColor>& Pixels, const FIntPoint& Size)
+{
+	UTexture2D* Texture = UTexture2D::CreateTransient(Size.X, Size.Y, PF_B8G8R8A8);
+	if (!Texture)
+	{
+		UE_LOG(LogDropByDropErosion, Error, TEXT("Failed to create the erosion preview texture!"));
+		return nullptr;
+	}
+
+	// "FColor" is stored in BGRA order, like the texture.
+	void* MipData = Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(MipData, Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+	Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
+
+	Texture->SRGB = true;
+	Texture->MipGenSettings = TMGS_NoMipmaps;
+	Texture->UpdateResource();
+
+	return Texture;
+}
+
+/**
+ * Dispatches the eroded heights to the in-place or to the new landscape path.
+ */
+bool UPipelineLibrary::ApplyErodedHeights(ALandscape* ActiveLandscape, TArray<float>&& ErodedHeights, const bool bApplyInPlace)
+{
+	return bApplyInPlace ? ApplyErodedHeightsInPlace(ActiveLandscape, MoveTemp(ErodedHeights)) : CreateErodedLandscape(ActiveLandscape, MoveTemp(ErodedHeights));
+}
+
 /**
  * Saves a new erosion preset template with specified parameters.
  * Templates allow users to save and reuse erosion configurations.
  */
-bool UPipelineLibrary::SaveErosionTemplate(const FString& TemplateName, const int32 ErosionCyclesValue, const float InertiaValue, const int32 CapacityValue, const float MinSlopeValue, const float DepositionSpeedValue, const float ErosionSpeedValue, const int32 GravityValue, const float EvaporationValue, const int32 MaxPathValue, const int32 ErosionRadiusValue)
+bool UPipelineLibrary::SaveErosionTemplate(const FString& TemplateName, const int32 ErosionCyclesValue, const int32 ErosionSeedValue, const float InertiaValue, const int32 CapacityValue, const float MinSlopeValue, const float DepositionSpeedValue, const float ErosionSpeedValue, const int32 GravityValue, const float EvaporationValue, const int32 MaxPathValue, const int32 ErosionRadiusValue)
 {
 	// Create a new template row and populate it with the provided parameters.
 	FErosionTemplateRow ErosionTemplateRow;
 
 	ErosionTemplateRow.ErosionCyclesField = ErosionCyclesValue;
+	ErosionTemplateRow.ErosionSeedField = ErosionSeedValue;
 	ErosionTemplateRow.InertiaField = InertiaValue;
 	ErosionTemplateRow.CapacityField = CapacityValue;
 	ErosionTemplateRow.MinimalSlopeField = MinSlopeValue;
@@ -263,6 +645,7 @@ bool UPipelineLibrary::LoadRowIntoErosionFields(TSharedPtr<FErosionSettings>& Ou
 
 	// Copy all erosion parameters from template to settings structure.
 	OutErosionSettings->ErosionCycles = TemplateDatas->ErosionCyclesField;
+	OutErosionSettings->ErosionSeed = TemplateDatas->ErosionSeedField;
 	OutErosionSettings->Inertia = TemplateDatas->InertiaField;
 	OutErosionSettings->Capacity = TemplateDatas->CapacityField;
 	OutErosionSettings->MinimalSlope = TemplateDatas->MinimalSlopeField;
@@ -312,7 +695,7 @@ bool UPipelineLibrary::CreateAndSaveHeightMap(FHeightMapGenerationSettings& Sett
 	Settings.HeightMap = CreateHeightMapArray(Settings);
 
 	// Create a visual texture from the heightmap data for preview and export.
-	UTexture2D* Texture = CreateHeightMapTexture(Settings.HeightMap, Settings.Size, Settings.Size);
+	UTexture2D* Texture = CreateHeightMapTexture(Settings.HeightMap, Settings.SizeX, Settings.SizeY);
 
 	if (!Texture)
 	{
@@ -331,87 +714,435 @@ bool UPipelineLibrary::CreateAndSaveHeightMap(FHeightMapGenerationSettings& Sett
 }
 
 /**
- * Generates a heightmap using multi-octave Perlin noise algorithm.
- * Implements:
- * - "Seed-based" random generation for reproducibility.
- * - Multiple octaves for terrain detail at different scales.
- * - Persistence and lacunarity for controlling octave influence.
- * - Normalization to specified height range.
+ * Permutation table of "FMath::PerlinNoise2D", copied from the engine so both noises give the same terrain:
+ * the values 0-255 in a fixed random order, repeated twice so corner hashes can be looked up without wrapping.
+ */
+static const int32 PerlinPermutation[512] =
+{
+	63, 9, 212, 205, 31, 128, 72, 59, 137, 203, 195, 170, 181, 115, 165, 40,
+	116, 139, 175, 225, 132, 99, 222, 2, 41, 15, 197, 93, 169, 90, 228, 43,
+	221, 38, 206, 204, 73, 17, 97, 10, 96, 47, 32, 138, 136, 30, 219, 78,
+	224, 13, 193, 88, 134, 211, 7, 112, 176, 19, 106, 83, 75, 217, 85, 0,
+	98, 140, 229, 80, 118, 151, 117, 251, 103, 242, 81, 238, 172, 82, 110, 4,
+	227, 77, 243, 46, 12, 189, 34, 188, 200, 161, 68, 76, 171, 194, 57, 48,
+	247, 233, 51, 105, 5, 23, 42, 50, 216, 45, 239, 148, 249, 84, 70, 125,
+	108, 241, 62, 66, 64, 240, 173, 185, 250, 49, 6, 37, 26, 21, 244, 60,
+	223, 255, 16, 145, 27, 109, 58, 102, 142, 253, 120, 149, 160, 124, 156, 79,
+	186, 135, 127, 14, 121, 22, 65, 54, 153, 91, 213, 174, 24, 252, 131, 192,
+	190, 202, 208, 35, 94, 231, 56, 95, 183, 163, 111, 147, 25, 67, 36, 92,
+	236, 71, 166, 1, 187, 100, 130, 143, 237, 178, 158, 104, 184, 159, 177, 52,
+	214, 230, 119, 87, 114, 201, 179, 198, 3, 248, 182, 39, 11, 152, 196, 113,
+	20, 232, 69, 141, 207, 234, 53, 86, 180, 226, 74, 150, 218, 29, 133, 8,
+	44, 123, 28, 146, 89, 101, 154, 220, 126, 155, 122, 210, 168, 254, 162, 129,
+	33, 18, 209, 61, 191, 199, 157, 245, 55, 164, 167, 215, 246, 144, 107, 235,
+	63, 9, 212, 205, 31, 128, 72, 59, 137, 203, 195, 170, 181, 115, 165, 40,
+	116, 139, 175, 225, 132, 99, 222, 2, 41, 15, 197, 93, 169, 90, 228, 43,
+	221, 38, 206, 204, 73, 17, 97, 10, 96, 47, 32, 138, 136, 30, 219, 78,
+	224, 13, 193, 88, 134, 211, 7, 112, 176, 19, 106, 83, 75, 217, 85, 0,
+	98, 140, 229, 80, 118, 151, 117, 251, 103, 242, 81, 238, 172, 82, 110, 4,
+	227, 77, 243, 46, 12, 189, 34, 188, 200, 161, 68, 76, 171, 194, 57, 48,
+	247, 233, 51, 105, 5, 23, 42, 50, 216, 45, 239, 148, 249, 84, 70, 125,
+	108, 241, 62, 66, 64, 240, 173, 185, 250, 49, 6, 37, 26, 21, 244, 60,
+	223, 255, 16, 145, 27, 109, 58, 102, 142, 253, 120, 149, 160, 124, 156, 79,
+	186, 135, 127, 14, 121, 22, 65, 54, 153, 91, 213, 174, 24, 252, 131, 192,
+	190, 202, 208, 35, 94, 231, 56, 95, 183, 163, 111, 147, 25, 67, 36, 92,
+	236, 71, 166, 1, 187, 100, 130, 143, 237, 178, 158, 104, 184, 159, 177, 52,
+	214, 230, 119, 87, 114, 201, 179, 198, 3, 248, 182, 39, 11, 152, 196, 113,
+	20, 232, 69, 141, 207, 234, 53, 86, 180, 226, 74, 150, 218, 29, 133, 8,
+	44, 123, 28, 146, 89, 101, 154, 220, 126, 155, 122, 210, 168, 254, 162, 129,
+	33, 18, 209, 61, 191, 199, 157, 245, 55, 164, 167, 215, 246, 144, 107, 235
+};
+
+/**
+ * Vectorized counterpart of "FMath::PerlinNoise2D".
+ * Floors, fractions, dot products, fade curve and interpolation run on all four lanes at once;
+ * only the permutation lookups, which need a gather, are done lane by lane.
+ */
+VectorRegister4Float UPipelineLibrary::VectorPerlinNoise2D(const VectorRegister4Float& LocationX, const VectorRegister4Float& LocationY)
+{
+	constexpr int32 NumLanes = 4;
+
+	// Gradient directions: corners and major axes of the unit square.
+	static constexpr float GradientX[8] = { 1.f, 1.f, 0.f, -1.f, -1.f, -1.f, 0.f, 1.f };
+	static constexpr float GradientY[8] = { 0.f, 1.f, 1.f, 1.f, 0.f, -1.f, -1.f, -1.f };
+
+	const int32* P = PerlinPermutation;
+
+	const VectorRegister4Float One = VectorOneFloat();
+	const VectorRegister4Float FloorX = VectorFloor(LocationX);
+	const VectorRegister4Float FloorY = VectorFloor(LocationY);
+
+	// Position inside the cell, relative to its lower and upper corners.
+	const VectorRegister4Float X = VectorSubtract(LocationX, FloorX);
+	const VectorRegister4Float Y = VectorSubtract(LocationY, FloorY);
+	const VectorRegister4Float Xm1 = VectorSubtract(X, One);
+	const VectorRegister4Float Ym1 = VectorSubtract(Y, One);
+
+	alignas(16) float FloorXLanes[NumLanes];
+	alignas(16) float FloorYLanes[NumLanes];
+	VectorStoreAligned(FloorX, FloorXLanes);
+	VectorStoreAligned(FloorY, FloorYLanes);
+
+	// Gradients of the four cell corners (lower-left, lower-right, upper-left, upper-right) of each lane.
+	alignas(16) float CornerGradientX[4][NumLanes];
+	alignas(16) float CornerGradientY[4][NumLanes];
+
+	for (int32 Lane = 0; Lane < NumLanes; Lane++)
+	{
+		const int32 Xi = static_cast<int32>(FloorXLanes[Lane]) & 255;
+		const int32 Yi = static_cast<int32>(FloorYLanes[Lane]) & 255;
+
+		const int32 AA = P[Xi] + Yi;
+		const int32 BA = P[Xi + 1] + Yi;
+		const int32 Hashes[4] = { P[AA] & 7, P[BA] & 7, P[AA + 1] & 7, P[BA + 1] & 7 };
+
+		for (int32 Corner = 0; Corner < 4; Corner++)
+		{
+			CornerGradientX[Corner][Lane] = GradientX[Hashes[Corner]];
+			CornerGradientY[Corner][Lane] = GradientY[Hashes[Corner]];
+		}
+	}
+
+	auto Dot = [&](const int32 Corner, const VectorRegister4Float& OffsetX, const VectorRegister4Float& OffsetY)
+		{
+			return VectorMultiplyAdd(VectorLoadAligned(CornerGradientX[Corner]), OffsetX, VectorMultiply(VectorLoadAligned(CornerGradientY[Corner]), OffsetY));
+		};
+
+	// Quintic fade curve 6t^5 - 15t^4 + 10t^3.
+	auto Fade = [](const VectorRegister4Float& T)
+		{
+			const VectorRegister4Float Polynomial = VectorMultiplyAdd(VectorMultiplyAdd(T, VectorSetFloat1(6.f), VectorSetFloat1(-15.f)), T, VectorSetFloat1(10.f));
+			return VectorMultiply(VectorMultiply(VectorMultiply(T, T), T), Polynomial);
+		};
+
+	auto Lerp = [](const VectorRegister4Float& A, const VectorRegister4Float& B, const VectorRegister4Float& Alpha)
+		{
+			return VectorMultiplyAdd(VectorSubtract(B, A), Alpha, A);
+		};
+
+	const VectorRegister4Float U = Fade(X);
+	const VectorRegister4Float V = Fade(Y);
+
+	return Lerp(
+		Lerp(Dot(0, X, Y), Dot(1, Xm1, Y), U),
+		Lerp(Dot(2, X, Ym1), Dot(3, Xm1, Ym1), U),
+		V);
+}
+
+/**
+ * The octave offsets come from the seed, in the same order as they always did, so a field sampled at the size
+ * of the settings gives the same heights as before.
+ * The bounds are estimated on a grid of HEIGHTMAP_BOUNDS_SAMPLES samples per side, widened by a margin
+ * unless the grid covers every cell.
+ */
+void UPipelineLibrary::CreateHeightMapNoiseField(const FHeightMapGenerationSettings& Settings, const FIntPoint& Size, FHeightMapNoiseField& OutField, const bool bEstimateBounds)
+{
+	OutField.Size = Size;
+	OutField.MapSize = static_cast<float>(FMath::Max3(Size.X, Size.Y, 1));
+	OutField.MaxHeightDifference = Settings.MaxHeightDifference;
+	OutField.bVectorizedNoise = Settings.bVectorizedNoise;
+
+	// Determine seed: either use random seed or fixed seed for reproducibility.
+	const int32 CurrentSeed = Settings.bRandomizeSeed ? FMath::RandRange(-10000, 10000) : Settings.Seed;
+	const FRandomStream RandomStream(CurrentSeed);
+
+	// Generate random offset for each octave to ensure variety.
+	OutField.Offsets.SetNum(Settings.NumOctaves);
+
+	for (uint32 Index = 0; Index < Settings.NumOctaves; Index++)
+	{
+		OutField.Offsets[Index] = FVector2D(RandomStream.FRandRange(-1000.0f, 1000.0f), RandomStream.FRandRange(-1000.0f, 1000.0f));
+	}
+
+	// Scale and weight of each octave, computed once for all the points.
+	// Persistence reduces the amplitude of each subsequent octave, lacunarity increases its frequency.
+	OutField.Scales.SetNum(Settings.NumOctaves);
+	OutField.Weights.SetNum(Settings.NumOctaves);
+
+	float Scale = Settings.InitialScale;
+	float Weight = 1.0f;
+
+	for (uint32 OctaveIndex = 0; OctaveIndex < Settings.NumOctaves; OctaveIndex++)
+	{
+		OutField.Scales[OctaveIndex] = Scale;
+		OutField.Weights[OctaveIndex] = Weight;
+
+		Weight *= Settings.Persistence;
+		Scale *= Settings.Lacunarity;
+	}
+
+	OutField.MinValue = 0.f;
+	OutField.MaxValue = 0.f;
+
+	if (!bEstimateBounds || Size.X <= 0 || Size.Y <= 0)
+	{
+		return;
+	}
+
+	// Evenly spaced rows and columns, both borders included.
+	const FIntPoint NumSamples(FMath::Min(Size.X, HEIGHTMAP_BOUNDS_SAMPLES), FMath::Min(Size.Y, HEIGHTMAP_BOUNDS_SAMPLES));
+
+	TArray<float> Samples;
+	Samples.SetNum(NumSamples.X * NumSamples.Y);
+
+	ParallelFor(NumSamples.Y, [&](const int32 SampleY)
+		{
+			const int32 Row = NumSamples.Y > 1 ? static_cast<int32>(static_cast<int64>(SampleY) * (Size.Y - 1) / (NumSamples.Y - 1)) : 0;
+
+			for (int32 SampleX = 0; SampleX < NumSamples.X; SampleX++)
+			{
+				const int32 Column = NumSamples.X > 1 ? static_cast<int32>(static_cast<int64>(SampleX) * (Size.X - 1) / (NumSamples.X - 1)) : 0;
+				SampleHeightMapRow(OutField, Row, Column, 1, &Samples[SampleY * NumSamples.X + SampleX]);
+			}
+		});
+
+	float MinValue = TNumericLimits<float>::Max();
+	float MaxValue = TNumericLimits<float>::Lowest();
+
+	for (const float Sample : Samples)
+	{
+		MinValue = FMath::Min(MinValue, Sample);
+		MaxValue = FMath::Max(MaxValue, Sample);
+	}
+
+	// Peaks and valleys between the samples can go past the sampled range.
+	if (NumSamples != Size)
+	{
+		const float Margin = (MaxValue - MinValue) * HEIGHTMAP_BOUNDS_MARGIN;
+		MinValue -= Margin;
+		MaxValue += Margin;
+	}
+
+	OutField.MinValue = MinValue;
+	OutField.MaxValue = MaxValue;
+}
+
+/**
+ * Sums the octaves of Perlin noise of each cell.
+ * With "bVectorizedNoise", the cells are sampled four at a time by "VectorPerlinNoise2D".
+ */
+void UPipelineLibrary::SampleHeightMapRow(const FHeightMapNoiseField& Field, const int32 Row, const int32 StartColumn, const int32 NumCells, float* OutNoise)
+{
+	const int32 NumOctaves = Field.Offsets.Num();
+
+	if (Field.bVectorizedNoise)
+	{
+		constexpr int32 NumLanes = 4;
+		const VectorRegister4Float LaneOffsets = MakeVectorRegister(0.f, 1.f, 2.f, 3.f);
+		alignas(16) float NoiseLanes[NumLanes];
+
+		for (int32 Cell = 0; Cell < NumCells; Cell += NumLanes)
+		{
+			const VectorRegister4Float PixelX = VectorAdd(VectorSetFloat1(static_cast<float>(StartColumn + Cell)), LaneOffsets);
+			VectorRegister4Float NoiseValue = VectorZeroFloat();
+
+			for (int32 OctaveIndex = 0; OctaveIndex < NumOctaves; OctaveIndex++)
+			{
+				const float Step = Field.Scales[OctaveIndex] / Field.MapSize;
+
+				// Same sample locations as the scalar path, in single precision.
+				const VectorRegister4Float LocationX = VectorMultiplyAdd(PixelX, VectorSetFloat1(Step), VectorSetFloat1(static_cast<float>(Field.Offsets[OctaveIndex].X)));
+				const VectorRegister4Float LocationY = VectorSetFloat1(static_cast<float>(Field.Offsets[OctaveIndex].Y) + Row * Step);
+
+				NoiseValue = VectorMultiplyAdd(VectorPerlinNoise2D(LocationX, LocationY), VectorSetFloat1(Field.Weights[OctaveIndex]), NoiseValue);
+			}
+
+			VectorStoreAligned(NoiseValue, NoiseLanes);
+
+			// The last group of the run may be partial.
+			const int32 NumValid = FMath::Min(NumLanes, NumCells - Cell);
+			FMemory::Memcpy(OutNoise + Cell, NoiseLanes, NumValid * sizeof(float));
+		}
+
+		return;
+	}
+
+	for (int32 Cell = 0; Cell < NumCells; Cell++)
+	{
+		float NoiseValue = 0.0f;
+
+		// Sum multiple octaves of Perlin noise.
+		// Each octave adds detail at a different frequency/scale.
+		for (int32 OctaveIndex = 0; OctaveIndex < NumOctaves; OctaveIndex++)
+		{
+			// Calculate sample location with offset and scale.
+			const FVector2D Location = Field.Offsets[OctaveIndex] + FVector2D(StartColumn + Cell, Row) / Field.MapSize * Field.Scales[OctaveIndex];
+
+			// Add weighted noise contribution from this octave.
+			NoiseValue += FMath::PerlinNoise2D(Location) * Field.Weights[OctaveIndex];
+		}
+
+		OutNoise[Cell] = NoiseValue;
+	}
+}
+
+/**
+ * Generates a heightmap using multi-octave Perlin noise algorithm.
+ * Implements:
+ * - "Seed-based" random generation for reproducibility.
+ * - Multiple octaves for terrain detail at different scales.
+ * - Persistence and lacunarity for controlling octave influence.
+ * - Normalization to specified height range.
+ * Rows are generated in parallel, each task keeping its own min/max, so the result does not depend on the number of threads.
+ * The whole heightmap is in memory, so it is normalized with its exact range rather than the estimated bounds of the field.
+ */
+TArray<float> UPipelineLibrary::CreateHeightMapArray(const FHeightMapGenerationSettings& Settings)
+{
+	const int32 MapSizeX = Settings.SizeX;
+	const int32 MapSizeY = Settings.SizeY;
+
+	FHeightMapNoiseField Field;
+	CreateHeightMapNoiseField(Settings, FIntPoint(MapSizeX, MapSizeY), Field, false);
+
+	// Pre-allocate array for all height values.
+	TArray<float> HeightMapValues;
+	HeightMapValues.SetNum(MapSizeX * MapSizeY);
+
+	// Min/max values for normalization, tracked by every task on its own rows and merged afterwards.
+	struct FHeightRange
+	{
+		float MinValue = TNumericLimits<float>::Max();
+		float MaxValue = TNumericLimits<float>::Lowest();
+	};
+
+	TArray<FHeightRange> TaskRanges;
+
+	// Generate Perlin Noise for each point in the heightmap, one row per iteration.
+	ParallelForWithTaskContext(TaskRanges, MapSizeY, [&](FHeightRange& Range, const int32 Height)
+		{
+			float* Row = HeightMapValues.GetData() + Height * MapSizeX;
+
+			SampleHeightMapRow(Field, Height, 0, MapSizeX, Row);
+
+			// Track range for normalization.
+			for (int32 Width = 0; Width < MapSizeX; Width++)
+			{
+				Range.MinValue = FMath::Min(Range.MinValue, Row[Width]);
+				Range.MaxValue = FMath::Max(Range.MaxValue, Row[Width]);
+			}
+		});
+
+	float MinValue = TNumericLimits<float>::Max();
+	float MaxValue = TNumericLimits<float>::Lowest();
+
+	for (const FHeightRange& Range : TaskRanges)
+	{
+		MinValue = FMath::Min(MinValue, Range.MinValue);
+		MaxValue = FMath::Max(MaxValue, Range.MaxValue);
+	}
+
+	// Normalize values to [0, MaxHeightDifference] range, in parallel as well.
+	if (!FMath::IsNearlyEqual(MinValue, MaxValue))
+	{
+		const float HeightScale = Settings.MaxHeightDifference / (MaxValue - MinValue);
+
+		ParallelFor(MapSizeY, [&](const int32 Height)
+			{
+				float* Row = HeightMapValues.GetData() + Height * MapSizeX;
+
+				for (int32 Width = 0; Width < MapSizeX; Width++)
+				{
+					// Map from [MinValue, MaxValue] to [0, MaxHeightDifference].
+					Row[Width] = (Row[Width] - MinValue) * HeightScale;
+				}
+			});
+	}
+
+	return HeightMapValues;
+}
+
+/**
+ * Rows of the tile are sampled in parallel and mapped from the bounds of the field to [0, MaxHeightDifference].
  */
-TArray<float> UPipelineLibrary::CreateHeightMapArray(const FHeightMapGenerationSettings& Settings)
+void UPipelineLibrary::GenerateHeightMapTile(const FHeightMapNoiseField& Field, const FIntRect& Tile, TArray<float>& OutHeights)
 {
-	const int32 MapSize = Settings.Size;
+	const int32 TileSizeX = Tile.Width();
+	const int32 TileSizeY = Tile.Height();
 
-	// Pre-allocate array for all height values.
-	TArray<float> HeightMapValues;
-	HeightMapValues.SetNum(MapSize * MapSize);
+	OutHeights.SetNum(TileSizeX * TileSizeY);
 
-	// Determine seed: either use random seed or fixed seed for reproducibility.
-	const int32 CurrentSeed = Settings.bRandomizeSeed ? FMath::RandRange(-10000, 10000) : Settings.Seed;
-	const FRandomStream RandomStream(CurrentSeed);
+	const bool bFlat = FMath::IsNearlyEqual(Field.MinValue, Field.MaxValue);
+	const float HeightScale = bFlat ? 0.f : Field.MaxHeightDifference / (Field.MaxValue - Field.MinValue);
 
-	// Generate random offset for each octave to ensure variety.
-	TArray<FVector2D> Offsets;
-	Offsets.SetNum(Settings.NumOctaves);
+	ParallelFor(TileSizeY, [&](const int32 Height)
+		{
+			float* Row = OutHeights.GetData() + Height * TileSizeX;
 
-	for (uint32 Index = 0; Index < Settings.NumOctaves; Index++)
+			SampleHeightMapRow(Field, Tile.Min.Y + Height, Tile.Min.X, TileSizeX, Row);
+
+			for (int32 Width = 0; Width < TileSizeX; Width++)
+			{
+				Row[Width] = FMath::Clamp((Row[Width] - Field.MinValue) * HeightScale, 0.f, Field.MaxHeightDifference);
+			}
+		});
+}
+
+/**
+ * Bands of full rows are generated and appended to the file one after the other, so only one band
+ * is ever in memory, whatever the size of the heightmap.
+ */
+bool UPipelineLibrary::GenerateHeightMapToFile(const FHeightMapGenerationSettings& Settings, const FIntPoint& Size, const FString& FilePath)
+{
+	if (Size.X <= 0 || Size.Y <= 0)
 	{
-		Offsets[Index] = FVector2D(RandomStream.FRandRange(-1000.0f, 1000.0f), RandomStream.FRandRange(-1000.0f, 1000.0f));
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Invalid %dx%d heightmap size!"), Size.X, Size.Y);
+		return false;
 	}
 
-	// Track min/max values for normalization.
-	float MinValue = TNumericLimits<float>::Max();
-	float MaxValue = TNumericLimits<float>::Lowest();
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
 
-	// Generate Perlin Noise for each point in the heightmap.
-	for (int32 Height = 0; Height < MapSize; Height++)
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*FilePath));
+	if (!FileHandle.IsValid())
 	{
-		for (int32 Width = 0; Width < MapSize; Width++)
-		{
-			float NoiseValue = 0.0f;
-			float Scale = Settings.InitialScale;
-			float Weight = 1.0f;
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Unable to create the heightmap file \"%s\"!"), *FilePath);
+		return false;
+	}
 
-			// Sum multiple octaves of Perlin noise.
-			// Each octave adds detail at a different frequency/scale.
-			for (uint32 OctaveIndex = 0; OctaveIndex < Settings.NumOctaves; OctaveIndex++)
-			{
-				// Calculate sample location with offset and scale.
-				FVector2D Location = Offsets[OctaveIndex] + FVector2D(Width, Height) / static_cast<float>(MapSize) * Scale;
+	FHeightMapNoiseField Field;
+	CreateHeightMapNoiseField(Settings, Size, Field);
+
+	// Tall enough to keep every worker busy, never more than the budget.
+	const int32 BandRows = FMath::Clamp(static_cast<int32>(HEIGHTMAP_STREAM_BAND_BYTES / (static_cast<int64>(Size.X) * sizeof(float))), 1, Size.Y);
+	const int32 NumBands = FMath::DivideAndRoundUp(Size.Y, BandRows);
 
-				// Add weighted noise contribution from this octave.
-				NoiseValue += FMath::PerlinNoise2D(Location) * Weight;
+	FScopedSlowTask SlowTask(NumBands, FText::FromString("Generating heightmap..."));
+	SlowTask.MakeDialog(true);
 
-				// Persistence: reduces the amplitude of each subsequent octave.
-				Weight *= Settings.Persistence;
+	TArray<float> BandHeights;
 
-				// Lacunarity: increases the frequency of each subsequent octave.
-				Scale *= Settings.Lacunarity;
-			}
+	for (int32 Band = 0; Band < NumBands; Band++)
+	{
+		if (SlowTask.ShouldCancel())
+		{
+			UE_LOG(LogDropByDropHeightmap, Warning, TEXT("Heightmap generation canceled, \"%s\" is incomplete!"), *FilePath);
+			return false;
+		}
 
-			const int32 Index = Height * MapSize + Width;
-			HeightMapValues[Index] = NoiseValue;
+		SlowTask.EnterProgressFrame(1);
 
-			// Track range for normalization.
-			MinValue = FMath::Min(MinValue, NoiseValue);
-			MaxValue = FMath::Max(MaxValue, NoiseValue);
+		const int32 FirstRow = Band * BandRows;
+		const FIntRect Tile(0, FirstRow, Size.X, FMath::Min(FirstRow + BandRows, Size.Y));
+
+		GenerateHeightMapTile(Field, Tile, BandHeights);
+
+		// Heights are stored in [0, 1], as "ConvertArrayFromFloatToUInt16" expects.
+		const TArray<uint16> BandHeightmap = ConvertArrayFromFloatToUInt16(BandHeights);
+		if (!FileHandle->Write(reinterpret_cast<const uint8*>(BandHeightmap.GetData()), BandHeightmap.Num() * sizeof(uint16)))
+		{
+			UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to write the heightmap file \"%s\"!"), *FilePath);
+			return false;
 		}
 	}
 
-	// Normalize values to [0, MaxHeightDifference] range.
-	if (!FMath::IsNearlyEqual(MinValue, MaxValue))
+	if (!SaveRawHeightmapSize(FilePath, Size))
 	{
-		for (float& Value : HeightMapValues)
-		{
-			// Map from [MinValue, MaxValue] to [0, 1].
-			Value = (Value - MinValue) / (MaxValue - MinValue);
-
-			// Scale to desired height range.
-			Value *= Settings.MaxHeightDifference;
-		}
+		return false;
 	}
 
-	return HeightMapValues;
+	UE_LOG(LogDropByDropHeightmap, Log, TEXT("%dx%d heightmap written to \"%s\" in %d bands."), Size.X, Size.Y, *FilePath, NumBands);
+
+	return true;
 }
 
 /**
@@ -490,8 +1221,8 @@ bool UPipelineLibrary::OpenHeightmapFileDialog(TSharedPtr<FExternalHeightMapSett
 	TArray<FString> OutFiles;
 	const void* ParentWindowHandle = FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr);
 
-	// Show file picker dialog filtered for PNG files.
-	bool bOpened = DesktopPlatform->OpenFileDialog(ParentWindowHandle, TEXT("Select Heightmap (PNG)"), FPaths::ProjectDir(), TEXT(EMPTY_STRING), TEXT("PNG files (*.png)|*.png"), EFileDialogFlags::None, OutFiles);
+	// Show file picker dialog filtered for PNG and RAW files.
+	bool bOpened = DesktopPlatform->OpenFileDialog(ParentWindowHandle, TEXT("Select Heightmap (PNG, RAW)"), FPaths::ProjectDir(), TEXT(EMPTY_STRING), TEXT("Heightmap files (*.png;*.r16;*.raw)|*.png;*.r16;*.raw"), EFileDialogFlags::None, OutFiles);
 
 	if (!bOpened || OutFiles.Num() <= 0)
 	{
@@ -502,18 +1233,29 @@ bool UPipelineLibrary::OpenHeightmapFileDialog(TSharedPtr<FExternalHeightMapSett
 	// Get the selected file (first result if multiple selected).
 	const FString& SelectedFile = OutFiles[0];
 
-	// Import the PNG file as a "Texture2D".
-	if (UTexture2D* Imported = FImageUtils::ImportFileAsTexture2D(SelectedFile))
+	// RAW files are only checked here and read when the landscape is created; no preview asset is saved for them.
+	if (IsRawHeightmapFile(SelectedFile))
 	{
-		if (!Imported)
+		FIntPoint RawSize;
+		if (!GetRawHeightmapSize(SelectedFile, RawSize))
 		{
-			UE_LOG(LogDropByDropHeightmap, Warning, TEXT("Failed to overwrite preview from PNG: %s"), *SelectedFile);
 			return false;
 		}
 
-		if (Imported->GetSurfaceWidth() != Imported->GetSurfaceHeight())
+		UE_LOG(LogDropByDropHeightmap, Log, TEXT("External RAW heightmap selected, without preview: %s (%dx%d)"), *SelectedFile, RawSize.X, RawSize.Y);
+
+		ExternalSettings->bIsExternalHeightMap = true;
+		ExternalSettings->LastPNGPath = SelectedFile;
+
+		return true;
+	}
+
+	// Import the PNG file as a "Texture2D".
+	if (UTexture2D* Imported = FImageUtils::ImportFileAsTexture2D(SelectedFile))
+	{
+		if (!Imported)
 		{
-			UE_LOG(LogDropByDropHeightmap, Error, TEXT("Imported texture isn't squared!"));
+			UE_LOG(LogDropByDropHeightmap, Warning, TEXT("Failed to overwrite preview from PNG: %s"), *SelectedFile);
 			return false;
 		}
 
@@ -536,15 +1278,67 @@ bool UPipelineLibrary::OpenHeightmapFileDialog(TSharedPtr<FExternalHeightMapSett
 	return false;
 }
 
+bool UPipelineLibrary::SaveHeightmapFileDialog(FString& OutFilePath)
+{
+	// Get the desktop platform interface for native dialogs.
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to open file dialog!"));
+		return false;
+	}
+
+	TArray<FString> OutFiles;
+	const void* ParentWindowHandle = FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr);
+
+	// Show file save dialog filtered for 16-bit RAW files.
+	const bool bSaved = DesktopPlatform->SaveFileDialog(ParentWindowHandle, TEXT("Save Heightmap (RAW)"), FPaths::ProjectSavedDir(), TEXT("HeightMap.r16"), TEXT("RAW files (*.r16;*.raw)|*.r16;*.raw"), EFileDialogFlags::None, OutFiles);
+
+	if (!bSaved || OutFiles.Num() <= 0)
+	{
+		return false;
+	}
+
+	OutFilePath = OutFiles[0];
+
+	return true;
+}
+
 /**
  * Loads heightmap data from an external PNG file on the file system.
  * Supports multiple pixel formats: RGBA8, BGRA8 G16, R32F and other common formats.
  * Outputs both raw uint16 data and normalized float data [0, 1].
+ * RAW files and PNG files are read directly, the texture import only handles the PNG files the decoder rejects.
  */
-void UPipelineLibrary::LoadHeightmapFromFileSystem(const FString& FilePath, TArray<uint16>& OutHeightMap, TArray<float>& OutNormalizedHeightmap, FExternalHeightMapSettings& Settings)
+void UPipelineLibrary::LoadHeightmapFromFileSystem(const FString& FilePath, TArray<uint16>& OutHeightMap, TArray<float>& OutNormalizedHeightmap, FIntPoint& OutSize, FExternalHeightMapSettings& Settings)
 {
 	OutHeightMap.Empty();
 	OutNormalizedHeightmap.Empty();
+	OutSize = FIntPoint::ZeroValue;
+
+	// RAW files already hold the 16-bit heights, they skip the texture import and the pixel format conversion.
+	if (IsRawHeightmapFile(FilePath))
+	{
+		if (LoadRawHeightmap(FilePath, OutHeightMap, OutSize))
+		{
+			OutNormalizedHeightmap = ConvertArrayFromUInt16ToFloat(OutHeightMap);
+			Settings.bIsExternalHeightMap = true;
+		}
+
+		return;
+	}
+
+	// PNG files are decoded straight into the heights, the texture import stays as a fallback.
+	if (FPaths::GetExtension(FilePath).Equals(TEXT("png"), ESearchCase::IgnoreCase))
+	{
+		if (LoadPngHeightmap(FilePath, OutHeightMap, OutNormalizedHeightmap, OutSize))
+		{
+			Settings.bIsExternalHeightMap = true;
+			return;
+		}
+
+		UE_LOG(LogDropByDropHeightmap, Warning, TEXT("Falling back to the texture import for: %s"), *FilePath);
+	}
 
 	// Import the PNG file as a texture.
 	UTexture2D* Texture = FImageUtils::ImportFileAsTexture2D(FilePath);
@@ -562,6 +1356,8 @@ void UPipelineLibrary::LoadHeightmapFromFileSystem(const FString& FilePath, TArr
 
 	UE_LOG(LogDropByDropHeightmap, Log, TEXT("Loaded Texture from PNG: Width = %d, Height = %d"), Width, Height);
 
+	OutSize = FIntPoint(Width, Height);
+
 	// Track min/max pixel values for normalization.
 	uint32 MinPixel = TNumericLimits<uint32>::Max();
 	uint32 MaxPixel = TNumericLimits<uint32>::Min();
@@ -671,6 +1467,288 @@ void UPipelineLibrary::LoadHeightmapFromFileSystem(const FString& FilePath, TArr
 	UE_LOG(LogDropByDropHeightmap, Log, TEXT("Heightmap loaded successfully. Min: %u, Max: %u"), MinPixel, MaxPixel);
 }
 
+/**
+ * RAW files carry no header: without a size file, the heightmap must be square, as for the landscape editor import.
+ * A size file that does not match the RAW file, left over by another tool overwriting it, is ignored.
+ */
+bool UPipelineLibrary::GetRawHeightmapSize(const FString& FilePath, FIntPoint& OutSize)
+{
+	OutSize = FIntPoint::ZeroValue;
+
+	const int64 FileSize = FPlatformFileManager::Get().GetPlatformFile().FileSize(*FilePath);
+	const int64 NumHeights = FileSize / static_cast<int64>(sizeof(uint16));
+
+	if (FileSize <= 0 || FileSize % sizeof(uint16) != 0 || NumHeights > MAX_int32)
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("\"%s\" is not a 16-bit RAW heightmap!"), *FilePath);
+		return false;
+	}
+
+	const FString SizeFilePath = FilePath + TEXT(RAW_HEIGHTMAP_SIZE_SUFFIX);
+	FString SizeText;
+	if (FFileHelper::LoadFileToString(SizeText, *SizeFilePath))
+	{
+		TArray<FString> Dimensions;
+		SizeText.ParseIntoArrayWS(Dimensions);
+
+		const int64 Width = Dimensions.Num() == 2 ? FCString::Atoi64(*Dimensions[0]) : 0;
+		const int64 Height = Dimensions.Num() == 2 ? FCString::Atoi64(*Dimensions[1]) : 0;
+
+		if (Width > 0 && Height > 0 && Width * Height == NumHeights)
+		{
+			OutSize = FIntPoint(static_cast<int32>(Width), static_cast<int32>(Height));
+			return true;
+		}
+
+		UE_LOG(LogDropByDropHeightmap, Warning, TEXT("\"%s\" does not match its RAW heightmap, ignoring it."), *SizeFilePath);
+	}
+
+	const int64 Side = FMath::RoundToInt64(FMath::Sqrt(static_cast<double>(NumHeights)));
+	if (Side * Side != NumHeights)
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("\"%s\" is not a square 16-bit RAW heightmap and has no \"%s\" file giving its size!"), *FilePath, TEXT(RAW_HEIGHTMAP_SIZE_SUFFIX));
+		return false;
+	}
+
+	OutSize = FIntPoint(static_cast<int32>(Side), static_cast<int32>(Side));
+	return true;
+}
+
+bool UPipelineLibrary::SaveRawHeightmapSize(const FString& FilePath, const FIntPoint& Size)
+{
+	const FString SizeFilePath = FilePath + TEXT(RAW_HEIGHTMAP_SIZE_SUFFIX);
+
+	if (Size.X == Size.Y)
+	{
+		FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*SizeFilePath);
+		return true;
+	}
+
+	if (!FFileHelper::SaveStringToFile(FString::Printf(TEXT("%d %d"), Size.X, Size.Y), *SizeFilePath))
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to write the size of the RAW heightmap: %s"), *SizeFilePath);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * The file is mapped and its heights are copied once into "OutHeightmap", the array handed over to the
+ * landscape import, without an intermediate byte buffer. Platforms without file mapping read it straight into that array.
+ */
+bool UPipelineLibrary::LoadRawHeightmap(const FString& FilePath, TArray<uint16>& OutHeightmap, FIntPoint& OutSize)
+{
+	OutHeightmap.Empty();
+	OutSize = FIntPoint::ZeroValue;
+
+	FIntPoint Size;
+	if (!GetRawHeightmapSize(FilePath, Size))
+	{
+		return false;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const int64 NumHeights = static_cast<int64>(Size.X) * Size.Y;
+	const int64 FileSize = NumHeights * sizeof(uint16);
+
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*FilePath));
+	TUniquePtr<IMappedFileRegion> MappedRegion(MappedFile.IsValid() ? MappedFile->MapRegion(0, FileSize) : nullptr);
+
+	if (MappedRegion.IsValid())
+	{
+		OutHeightmap.Append(reinterpret_cast<const uint16*>(MappedRegion->GetMappedPtr()), static_cast<int32>(NumHeights));
+	}
+	else
+	{
+		TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(*FilePath));
+		OutHeightmap.SetNumUninitialized(static_cast<int32>(NumHeights));
+
+		if (!FileHandle.IsValid() || !FileHandle->Read(reinterpret_cast<uint8*>(OutHeightmap.GetData()), FileSize))
+		{
+			OutHeightmap.Empty();
+			UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to read the RAW file: %s"), *FilePath);
+			return false;
+		}
+	}
+
+	OutSize = Size;
+
+	UE_LOG(LogDropByDropHeightmap, Log, TEXT("Loaded RAW heightmap: Width = %d, Height = %d"), OutSize.X, OutSize.Y);
+
+	return true;
+}
+
+/**
+ * The image is decoded once at its own bit depth, 16-bit grayscale images keeping all their precision;
+ * 8-bit values are spread over the whole 16-bit range instead of being shifted.
+ * Rows are then converted in parallel, the min/max of each task tracked in the same loop,
+ * and normalized in a second parallel pass; nothing is allocated per row.
+ */
+bool UPipelineLibrary::LoadPngHeightmap(const FString& FilePath, TArray<uint16>& OutHeightmap, TArray<float>& OutNormalizedHeightmap, FIntPoint& OutSize)
+{
+	OutHeightmap.Empty();
+	OutNormalizedHeightmap.Empty();
+	OutSize = FIntPoint::ZeroValue;
+
+	TArray64<uint8> CompressedData;
+	if (!FFileHelper::LoadFileToArray(CompressedData, *FilePath))
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to load PNG file: %s"), *FilePath);
+		return false;
+	}
+
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	const TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+	if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(CompressedData.GetData(), CompressedData.Num()))
+	{
+		UE_LOG(LogDropByDropHeightmap, Warning, TEXT("Unable to decode PNG file: %s"), *FilePath);
+		return false;
+	}
+
+	const int64 Width = ImageWrapper->GetWidth();
+	const int64 Height = ImageWrapper->GetHeight();
+
+	// Gray images are decoded as they are, color images keep the red channel as the texture import does.
+	const bool bGray = ImageWrapper->GetFormat() == ERGBFormat::Gray;
+	const int32 NumChannels = bGray ? 1 : 4;
+	const int32 BitDepth = ImageWrapper->GetBitDepth() == 16 ? 16 : 8;
+
+	TArray64<uint8> DecodedData;
+	if (Width <= 0 || Height <= 0 || Width * Height > MAX_int32 || !ImageWrapper->GetRaw(bGray ? ERGBFormat::Gray : ERGBFormat::RGBA, BitDepth, DecodedData))
+	{
+		UE_LOG(LogDropByDropHeightmap, Warning, TEXT("Unable to decode PNG file: %s"), *FilePath);
+		return false;
+	}
+
+	// The compressed file is no longer needed, release it before allocating the heights.
+	CompressedData.Empty();
+
+	UE_LOG(LogDropByDropHeightmap, Log, TEXT("Decoded %d-bit PNG: Width = %lld, Height = %lld"), BitDepth, Width, Height);
+
+	OutSize = FIntPoint(static_cast<int32>(Width), static_cast<int32>(Height));
+	OutHeightmap.SetNumUninitialized(OutSize.X * OutSize.Y);
+	OutNormalizedHeightmap.SetNumUninitialized(OutSize.X * OutSize.Y);
+
+	// Min/max pixel values for normalization, tracked by every task on its own rows and merged afterwards.
+	struct FPixelRange
+	{
+		uint16 MinPixel = TNumericLimits<uint16>::Max();
+		uint16 MaxPixel = TNumericLimits<uint16>::Min();
+	};
+
+	TArray<FPixelRange> TaskRanges;
+
+	ParallelForWithTaskContext(TaskRanges, OutSize.Y, [&](FPixelRange& Range, const int32 Row)
+		{
+			uint16* Heights = OutHeightmap.GetData() + Row * OutSize.X;
+			const int64 FirstSample = static_cast<int64>(Row) * OutSize.X * NumChannels;
+
+			if (BitDepth == 16)
+			{
+				const uint16* Samples = reinterpret_cast<const uint16*>(DecodedData.GetData()) + FirstSample;
+				for (int32 Column = 0; Column < OutSize.X; Column++)
+				{
+					const uint16 HeightValue = Samples[Column * NumChannels];
+
+					Heights[Column] = HeightValue;
+					Range.MinPixel = FMath::Min(Range.MinPixel, HeightValue);
+					Range.MaxPixel = FMath::Max(Range.MaxPixel, HeightValue);
+				}
+			}
+			else
+			{
+				const uint8* Samples = DecodedData.GetData() + FirstSample;
+				for (int32 Column = 0; Column < OutSize.X; Column++)
+				{
+					// 255 maps to 65535.
+					const uint16 HeightValue = static_cast<uint16>(Samples[Column * NumChannels] * 257);
+
+					Heights[Column] = HeightValue;
+					Range.MinPixel = FMath::Min(Range.MinPixel, HeightValue);
+					Range.MaxPixel = FMath::Max(Range.MaxPixel, HeightValue);
+				}
+			}
+		});
+
+	uint16 MinPixel = TNumericLimits<uint16>::Max();
+	uint16 MaxPixel = TNumericLimits<uint16>::Min();
+
+	for (const FPixelRange& Range : TaskRanges)
+	{
+		MinPixel = FMath::Min(MinPixel, Range.MinPixel);
+		MaxPixel = FMath::Max(MaxPixel, Range.MaxPixel);
+	}
+
+	// Normalize heightmap values to [0, 1] range.
+	const float PixelScale = MaxPixel > MinPixel ? 1.f / static_cast<float>(MaxPixel - MinPixel) : 0.f;
+
+	ParallelFor(OutSize.Y, [&](const int32 Row)
+		{
+			const int32 RowStart = Row * OutSize.X;
+			for (int32 Index = RowStart; Index < RowStart + OutSize.X; Index++)
+			{
+				OutNormalizedHeightmap[Index] = (OutHeightmap[Index] - MinPixel) * PixelScale;
+			}
+		});
+
+	UE_LOG(LogDropByDropHeightmap, Log, TEXT("Heightmap loaded successfully. Min: %u, Max: %u"), MinPixel, MaxPixel);
+
+	return true;
+}
+
+bool UPipelineLibrary::IsRawHeightmapFile(const FString& FilePath)
+{
+	const FString Extension = FPaths::GetExtension(FilePath);
+	return Extension.Equals(TEXT("r16"), ESearchCase::IgnoreCase) || Extension.Equals(TEXT("raw"), ESearchCase::IgnoreCase);
+}
+
+bool UPipelineLibrary::SaveRawHeightmap(const FString& FilePath, TConstArrayView<uint16> Heightmap, const FIntPoint& Size)
+{
+	check(Heightmap.Num() == static_cast<int64>(Size.X) * Size.Y);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+	TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenWrite(*FilePath));
+	if (!FileHandle.IsValid() || !FileHandle->Write(reinterpret_cast<const uint8*>(Heightmap.GetData()), static_cast<int64>(Heightmap.Num()) * sizeof(uint16)))
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to write the RAW file: %s"), *FilePath);
+		return false;
+	}
+
+	return SaveRawHeightmapSize(FilePath, Size);
+}
+
+/**
+ * The stored heights are the ones of the landscape, so they are quantized back to the exact landscape values.
+ */
+bool UPipelineLibrary::ExportLandscapeHeightmap(const ALandscape* ActiveLandscape, const FString& FilePath)
+{
+	const ULandscapeInfoComponent* ActiveLandscapeInfoComponent = IsValid(ActiveLandscape) ? ActiveLandscape->FindComponentByClass<ULandscapeInfoComponent>() : nullptr;
+	if (!ActiveLandscapeInfoComponent)
+	{
+		UE_LOG(LogDropByDropLandscape, Error, TEXT("The \"Active Landscape\" resource is invalid!"));
+		return false;
+	}
+
+	const FHeightMapGenerationSettings& HeightMapSettings = ActiveLandscapeInfoComponent->GetHeightMapSettings();
+	if (HeightMapSettings.HeightMap.Num() <= 0 || HeightMapSettings.HeightMap.Num() != static_cast<int64>(HeightMapSettings.SizeX) * HeightMapSettings.SizeY)
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("The landscape has no stored heightmap to export!"));
+		return false;
+	}
+
+	if (!SaveRawHeightmap(FilePath, ConvertArrayFromFloatToUInt16(HeightMapSettings.HeightMap), FIntPoint(HeightMapSettings.SizeX, HeightMapSettings.SizeY)))
+	{
+		return false;
+	}
+
+	UE_LOG(LogDropByDropHeightmap, Log, TEXT("%ux%u landscape heightmap exported to \"%s\"."), HeightMapSettings.SizeX, HeightMapSettings.SizeY, *FilePath);
+
+	return true;
+}
+
 /**
  * Debug utility to compare a generated heightmap with a RAW file exported by Unreal.
  * Used for validation and troubleshooting heightmap generation.
@@ -713,13 +1791,16 @@ void UPipelineLibrary::CompareHeightmaps(const FString& RawFilePath, const TArra
  * Internal function to initialize and create a landscape with given heightmap data.
  * Sets up the landscape and stores generation settings in its info component.
  */
-bool UPipelineLibrary::InitLandscape(TArray<uint16>& HeightData, FHeightMapGenerationSettings& HeightmapSettings, FExternalHeightMapSettings& ExternalSettings, FLandscapeGenerationSettings& LandscapeSettings)
+bool UPipelineLibrary::InitLandscape(TArray<uint16>&& HeightData, const FIntPoint& HeightmapSize, FHeightMapGenerationSettings& HeightmapSettings, FExternalHeightMapSettings& ExternalSettings, FLandscapeGenerationSettings& LandscapeSettings)
 {
-	// Calculate world transform for the new landscape usando 505
-	const FTransform LandscapeTransform = GetNewTransform(ExternalSettings, LandscapeSettings, 505);
+	// Calculate world transform for the new landscape.
+	const FTransform LandscapeTransform = GetNewTransform(ExternalSettings, LandscapeSettings, HeightmapSize);
+
+	// The stored heights are the imported ones, before the import takes ownership of them.
+	TArray<float> StoredHeightMap = ConvertArrayFromUInt16ToFloat(HeightData);
 
 	// Spawn the landscape with heightmap data.
-	TObjectPtr<ALandscape> NewLandscape = GenerateLandscape(LandscapeTransform, HeightData);
+	TObjectPtr<ALandscape> NewLandscape = GenerateLandscape(LandscapeTransform, MoveTemp(HeightData), HeightmapSize);
 	if (!IsValid(NewLandscape))
 	{
 		UE_LOG(LogDropByDropLandscape, Error, TEXT("Failed to generate the landscape!"));
@@ -735,15 +1816,16 @@ bool UPipelineLibrary::InitLandscape(TArray<uint16>& HeightData, FHeightMapGener
 	}
 
 	FHeightMapGenerationSettings UpdatedHeightmapSettings = HeightmapSettings;
-	UpdatedHeightmapSettings.Size = STANDARD_HEIGHTMAP_SIZE;
-	UpdatedHeightmapSettings.HeightMap = ConvertArrayFromUInt16ToFloat(HeightData);
+	UpdatedHeightmapSettings.SizeX = HeightmapSize.X;
+	UpdatedHeightmapSettings.SizeY = HeightmapSize.Y;
+	UpdatedHeightmapSettings.HeightMap = MoveTemp(StoredHeightMap);
 
 	// Store all generation settings in the info component for later reference.
 	NewLandscapeInfo->SetHeightMapSettings(UpdatedHeightmapSettings);
 	NewLandscapeInfo->SetExternalSettings(ExternalSettings);
 	NewLandscapeInfo->SetLandscapeSettings(LandscapeSettings);
 
-	UE_LOG(LogDropByDropLandscape, Log, TEXT("Landscape created successfully at standard size 505x505!"));
+	UE_LOG(LogDropByDropLandscape, Log, TEXT("Landscape created successfully at size %dx%d!"), HeightmapSize.X, HeightmapSize.Y);
 
 	return true;
 }
@@ -775,7 +1857,14 @@ bool UPipelineLibrary::CreateLandscapeFromInternalHeightMap(FHeightMapGeneration
 	}
 
 	TArray<uint16> HeightmapU16 = ConvertArrayFromFloatToUInt16(HeightmapSettings.HeightMap);
-	TArray<uint16> StandardizedHeightmap = StandardizeHeightmapResolution(HeightmapU16);
+
+	FIntPoint HeightmapSize;
+	TArray<uint16> StandardizedHeightmap = StandardizeHeightmapResolution(MoveTemp(HeightmapU16), FIntPoint(HeightmapSettings.SizeX, HeightmapSettings.SizeY), HeightmapSize);
+	if (StandardizedHeightmap.Num() <= 0)
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("The heightmap does not match its %ux%u size!"), HeightmapSettings.SizeX, HeightmapSettings.SizeY);
+		return false;
+	}
 
 	// Validate world context.
 	const UWorld* World = GEditor->GetEditorWorldContext().World();
@@ -785,11 +1874,11 @@ bool UPipelineLibrary::CreateLandscapeFromInternalHeightMap(FHeightMapGeneration
 		return false;
 	}
 
-	return InitLandscape(StandardizedHeightmap, HeightmapSettings, ExternalSettings, LandscapeSettings);
+	return InitLandscape(MoveTemp(StandardizedHeightmap), HeightmapSize, HeightmapSettings, ExternalSettings, LandscapeSettings);
 }
 
 /**
- * Creates a landscape from an external heightmap file (PNG).
+ * Creates a landscape from an external heightmap file (PNG or RAW).
  * Loads the file, validates it, and creates the landscape.
  */
 bool UPipelineLibrary::CreateLandscapeFromExternalHeightMap(const FString& FilePath, FExternalHeightMapSettings& ExternalSettings, FLandscapeGenerationSettings& LandscapeSettings, FHeightMapGenerationSettings& HeightmapSettings)
@@ -800,26 +1889,33 @@ bool UPipelineLibrary::CreateLandscapeFromExternalHeightMap(const FString& FileP
 
 	// Load heightmap data from the PNG file (può essere di qualsiasi risoluzione)
 	TArray<uint16> HeightMapInt16;
-	LoadHeightmapFromFileSystem(FilePath, HeightMapInt16, HeightmapSettings.HeightMap, ExternalSettings);
+	FIntPoint SourceSize;
+	LoadHeightmapFromFileSystem(FilePath, HeightMapInt16, HeightmapSettings.HeightMap, SourceSize, ExternalSettings);
 
 	// Validate that heightmap was loaded successfully.
 	if (HeightMapInt16.Num() <= 0)
 	{
-		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to load heightmap from PNG file!"));
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("Failed to load heightmap from the external file!"));
 		return false;
 	}
 
-	TArray<uint16> StandardizedHeightmap = StandardizeHeightmapResolution(HeightMapInt16);
+	FIntPoint HeightmapSize;
+	TArray<uint16> StandardizedHeightmap = StandardizeHeightmapResolution(MoveTemp(HeightMapInt16), SourceSize, HeightmapSize);
+	if (StandardizedHeightmap.Num() <= 0)
+	{
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("The external heightmap does not match its %dx%d size!"), SourceSize.X, SourceSize.Y);
+		return false;
+	}
 
 	// Optional: Debug comparison with RAW file if it exists.
 	FString HeightMapPath = FPaths::ProjectDir() + TEXT(HEIGHTMAP_PATH_SUFFIX);
 	if (FPaths::FileExists(HeightMapPath))
 	{
-		CompareHeightmaps(HeightMapPath, StandardizedHeightmap, STANDARD_HEIGHTMAP_SIZE, STANDARD_HEIGHTMAP_SIZE);
+		CompareHeightmaps(HeightMapPath, StandardizedHeightmap, HeightmapSize.X, HeightmapSize.Y);
 	}
 
 	// Create the landscape with the standardized heightmap.
-	return InitLandscape(StandardizedHeightmap, HeightmapSettings, ExternalSettings, LandscapeSettings);
+	return InitLandscape(MoveTemp(StandardizedHeightmap), HeightmapSize, HeightmapSettings, ExternalSettings, LandscapeSettings);
 }
 
 /**
@@ -849,14 +1945,14 @@ bool UPipelineLibrary::GenerateLandscapeAuto(FHeightMapGenerationSettings& Heigh
  * Spawns a landscape and imports heightmap data using Unreal's landscape API.
  * Handles component size calculation, layer setup, and actor initialization.
  */
-TObjectPtr<ALandscape> UPipelineLibrary::GenerateLandscape(const FTransform& LandscapeTransform, TArray<uint16>& Heightmap)
+TObjectPtr<ALandscape> UPipelineLibrary::GenerateLandscape(const FTransform& LandscapeTransform, TArray<uint16>&& Heightmap, const FIntPoint& HeightmapSize)
 {
-	int32 SubSectionSizeQuads;
-	int32 NumSubsections;
+	int32 SubSectionSizeQuads = LANDSCAPE_DEFAULT_SUBSECTION_SIZE_QUADS;
+	int32 NumSubsections = LANDSCAPE_DEFAULT_NUM_SUBSECTIONS;
 	int32 MaxX, MaxY;
 
 	// Calculate optimal landscape component parameters.
-	if (!SetLandscapeSizeParam(SubSectionSizeQuads, NumSubsections, MaxX, MaxY))
+	if (!SetLandscapeSizeParam(SubSectionSizeQuads, NumSubsections, MaxX, MaxY, HeightmapSize))
 	{
 		return nullptr;
 	}
@@ -877,7 +1973,7 @@ TObjectPtr<ALandscape> UPipelineLibrary::GenerateLandscape(const FTransform& Lan
 		return nullptr;
 	}
 
-	HeightDataPerLayer.Add(FGuid(), Heightmap);
+	HeightDataPerLayer.Add(FGuid(), MoveTemp(Heightmap));
 
 	// Get editor world context.
 	const FWorldContext& EditorWorldContext = GEditor->GetEditorWorldContext();
@@ -1026,13 +2122,13 @@ bool UPipelineLibrary::SplitLandscapeIntoProxies(ALandscape& ActiveLandscape)
  * Unreal landscapes have strict size requirements (power-of-2 based).
  * Uses "FLandscapeImportHelper" to determine best component configuration.
  */
-bool UPipelineLibrary::SetLandscapeSizeParam(int32& SubSectionSizeQuads, int32& NumSubsections, int32& MaxX, int32& MaxY, const int32 Size)
+bool UPipelineLibrary::SetLandscapeSizeParam(int32& SubSectionSizeQuads, int32& NumSubsections, int32& MaxX, int32& MaxY, const FIntPoint& Size)
 {
-	const int32 HeightmapSize = Size;
+	const FIntPoint HeightmapSize = Size;
 	FIntPoint NewLandscapeComponentCount;
 
 	// Let Unreal determine the best component subdivision.
-	FLandscapeImportHelper::ChooseBestComponentSizeForImport(HeightmapSize, HeightmapSize, SubSectionSizeQuads, NumSubsections, NewLandscapeComponentCount);
+	FLandscapeImportHelper::ChooseBestComponentSizeForImport(HeightmapSize.X, HeightmapSize.Y, SubSectionSizeQuads, NumSubsections, NewLandscapeComponentCount);
 
 	// Calculate total landscape dimensions.
 	const int32 ComponentCountX = NewLandscapeComponentCount.X;
@@ -1044,9 +2140,9 @@ bool UPipelineLibrary::SetLandscapeSizeParam(int32& SubSectionSizeQuads, int32&
 	MaxY = ComponentCountY * QuadsPerComponent + 1;
 
 	// Verify calculated size matches input heightmap size.
-	if (MaxX != HeightmapSize || MaxY != HeightmapSize)
+	if (MaxX != HeightmapSize.X || MaxY != HeightmapSize.Y)
 	{
-		UE_LOG(LogDropByDropLandscape, Error, TEXT("Size calculated (%d x %d) not match with size of HeightMap (%d x %d)"), MaxX, MaxY, HeightmapSize, HeightmapSize)
+		UE_LOG(LogDropByDropLandscape, Error, TEXT("Size calculated (%d x %d) not match with size of HeightMap (%d x %d)"), MaxX, MaxY, HeightmapSize.X, HeightmapSize.Y)
 		return false;
 	}
 
@@ -1061,7 +2157,7 @@ bool UPipelineLibrary::SetLandscapeSizeParam(int32& SubSectionSizeQuads, int32&
  * Calculates the world transform for a new landscape.
  * Handles both external heightmap scaling and procedural landscape kilometer-based scaling.
  */
-FTransform UPipelineLibrary::GetNewTransform(const FExternalHeightMapSettings& ExternalSettings, const FLandscapeGenerationSettings& LandscapeSettings, int32 HeightmapSize)
+FTransform UPipelineLibrary::GetNewTransform(const FExternalHeightMapSettings& ExternalSettings, const FLandscapeGenerationSettings& LandscapeSettings, const FIntPoint& HeightmapSize)
 {
 	FVector NewScale;
 
@@ -1074,7 +2170,7 @@ FTransform UPipelineLibrary::GetNewTransform(const FExternalHeightMapSettings& E
 	{
 		// Calculate scale to achieve desired size in kilometers.
 		const FVector BaseScale = FVector(100, 100, 100); // Base Unreal landscape scale.
-		const float CurrentSizeInUnits = HeightmapSize * BaseScale.X;
+		const float CurrentSizeInUnits = FMath::Max(HeightmapSize.X, HeightmapSize.Y) * BaseScale.X;
 
 		// Convert kilometers to Unreal units (1 km = 100,000 cm).
 		const float DesiredSizeInUnits = LandscapeSettings.Kilometers * 1000.f * 100.f;
@@ -0,0 +1,180 @@
+﻿// © Manuel Solano
+// © Roberto Capparelli
+
+#include "Libraries/ErosionLibrary.h"
+
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTLS.h"
+#include "DropByDropSettings.h"
+#include "DropByDropLogger.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Side of the heightmap eroded by the test.
+#define ALLOCATION_TEST_GRID_SIZE 129
+
+// Drops of the short and of the long run, the long one simulating many more batches than the short one.
+#define ALLOCATION_TEST_SHORT_DROPS 2000
+#define ALLOCATION_TEST_LONG_DROPS 40000
+
+/**
+ * Allocator forwarding everything to the global one, counting the allocations made by a single thread.
+ * Other threads keep allocating while it is installed, only the test thread is counted.
+ */
+class FErosionCountingMalloc final : public FMalloc
+{
+public:
+	explicit FErosionCountingMalloc(FMalloc* InInnerMalloc)
+		: InnerMalloc(InInnerMalloc)
+		, ThreadId(FPlatformTLS::GetCurrentThreadId())
+	{
+	}
+
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+	{
+		CountAllocation(true);
+		return InnerMalloc->Malloc(Count, Alignment);
+	}
+
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+	{
+		// Shrinking to zero is a free.
+		CountAllocation(Count > 0);
+		return InnerMalloc->Realloc(Original, Count, Alignment);
+	}
+
+	virtual void Free(void* Original) override
+	{
+		InnerMalloc->Free(Original);
+	}
+
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+	{
+		return InnerMalloc->QuantizeSize(Count, Alignment);
+	}
+
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+	{
+		return InnerMalloc->GetAllocationSize(Original, SizeOut);
+	}
+
+	virtual bool IsInternallyThreadSafe() const override
+	{
+		return InnerMalloc->IsInternallyThreadSafe();
+	}
+
+	virtual void Trim(bool bTrimThreadCaches) override
+	{
+		InnerMalloc->Trim(bTrimThreadCaches);
+	}
+
+	virtual const TCHAR* GetDescriptiveName() override
+	{
+		return TEXT("ErosionCountingMalloc");
+	}
+
+	int64 GetNumAllocations() const
+	{
+		return NumAllocations.load(std::memory_order_relaxed);
+	}
+
+private:
+	void CountAllocation(const bool bAllocates)
+	{
+		if (bAllocates && FPlatformTLS::GetCurrentThreadId() == ThreadId)
+		{
+			NumAllocations.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	FMalloc* InnerMalloc;
+	uint32 ThreadId;
+	std::atomic<int64> NumAllocations = 0;
+};
+
+/**
+ * Erodes a fresh copy of the heights with the given number of drops and returns the allocations it made,
+ * setup included. The erosion log is silenced so messages do not count.
+ */
+static int64 CountErosionAllocations(const TArray<float>& Heights, FErosionSettings ErosionSettings, const int64 NumDrops)
+{
+	ErosionSettings.ErosionCycles = NumDrops;
+
+	FErosionContext ErosionContext;
+	UErosionLibrary::SetHeights(ErosionContext, Heights);
+
+	const ELogVerbosity::Type Verbosity = LogDropByDropErosion.GetVerbosity();
+	LogDropByDropErosion.SetVerbosity(ELogVerbosity::Fatal);
+
+	FMalloc* GlobalMalloc = GMalloc;
+	FErosionCountingMalloc CountingMalloc(GlobalMalloc);
+
+	GMalloc = &CountingMalloc;
+	UErosionLibrary::Erosion(ErosionContext, ErosionSettings, FIntPoint(ALLOCATION_TEST_GRID_SIZE, ALLOCATION_TEST_GRID_SIZE));
+	GMalloc = GlobalMalloc;
+
+	LogDropByDropErosion.SetVerbosity(Verbosity);
+
+	// The context is destroyed with the inner allocator back in place.
+	return CountingMalloc.GetNumAllocations();
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FErosionAllocationTest, "DropByDrop.Erosion.AllocationFree", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+/**
+ * The serial erosion must allocate everything during its setup: a run with many more drops
+ * than another one must then make exactly as many allocations.
+ * Every kernel and spawn variant is checked; the parallel erosion is not, "ParallelFor" allocates its tasks.
+ */
+bool FErosionAllocationTest::RunTest(const FString& Parameters)
+{
+	// Ridged slopes, so drops flow, erode and deposit on every step.
+	TArray<float> Heights;
+	Heights.SetNumUninitialized(ALLOCATION_TEST_GRID_SIZE * ALLOCATION_TEST_GRID_SIZE);
+
+	for (int32 Y = 0; Y < ALLOCATION_TEST_GRID_SIZE; Y++)
+	{
+		for (int32 X = 0; X < ALLOCATION_TEST_GRID_SIZE; X++)
+		{
+			Heights[X + Y * ALLOCATION_TEST_GRID_SIZE] = 0.5f + 0.25f * FMath::Sin(X * 0.1f) * FMath::Cos(Y * 0.07f) + 0.002f * (X + Y);
+		}
+	}
+
+	FErosionSettings Scalar;
+	Scalar.bParallelErosion = false;
+	Scalar.bOutOfCoreErosion = false;
+	Scalar.bMultiresolutionErosion = false;
+
+	FErosionSettings Vectorized = Scalar;
+	Vectorized.bVectorizedErosion = true;
+
+	FErosionSettings Stratified = Scalar;
+	Stratified.bStratifiedSpawn = true;
+	Stratified.GridBlockSize = 8;
+
+	FErosionSettings Importance = Vectorized;
+	Importance.bImportanceSpawn = true;
+
+	const TPair<const TCHAR*, FErosionSettings> Variants[] =
+	{
+		{ TEXT("Scalar"), Scalar },
+		{ TEXT("Vectorized"), Vectorized },
+		{ TEXT("Stratified, blocked grid"), Stratified },
+		{ TEXT("Importance spawn"), Importance },
+	};
+
+	for (const TPair<const TCHAR*, FErosionSettings>& Variant : Variants)
+	{
+		// A first run takes care of the one-time initializations (console variables, statics).
+		CountErosionAllocations(Heights, Variant.Value, ALLOCATION_TEST_SHORT_DROPS);
+
+		const int64 ShortAllocations = CountErosionAllocations(Heights, Variant.Value, ALLOCATION_TEST_SHORT_DROPS);
+		const int64 LongAllocations = CountErosionAllocations(Heights, Variant.Value, ALLOCATION_TEST_LONG_DROPS);
+
+		TestEqual(FString::Printf(TEXT("%s: allocations after setup"), Variant.Key), LongAllocations - ShortAllocations, static_cast<int64>(0));
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
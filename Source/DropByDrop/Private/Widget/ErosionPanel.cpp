@@ -5,14 +5,24 @@
 
 #include "Components/LandscapeInfoComponent.h"
 #include "Widgets/Input/SNumericEntryBox.h"
+#include "Widgets/Notifications/SProgressBar.h"
+#include "Framework/Application/SlateApplication.h"
 #include "Libraries/PipelineLibrary.h"
+#include "Libraries/ErosionLibrary.h"
 #include "Widget/TemplateBrowser.h"
 #include "DropByDropNotifications.h"
+#include "Engine/Texture2D.h"
 #include "Landscape.h"
 
 #define EMPTY_STRING ""
 #define DEFAULT_WIND_DIRECTION EWindDirection::Random
 
+// Seconds without edits before the erosion preview starts.
+#define EROSION_PREVIEW_DELAY 0.05
+
+// Side, in slate units, of the erosion preview image.
+#define EROSION_PREVIEW_DISPLAY_SIZE 256
+
 /**
  * Constructs the erosion panel UI with all erosion parameter controls.
  *
@@ -38,6 +48,8 @@ void SErosionPanel::Construct(const FArguments& Args)
 	// Populate the wind direction dropdown options.
 	BuildWindDirections();
 
+	PreviewBrush = MakeShared<FSlateBrush>();
+
 	ChildSlot
 		[
 			SNew(SVerticalBox)
@@ -67,6 +79,86 @@ void SErosionPanel::Construct(const FArguments& Args)
 								.OnValueChanged_Lambda([E = Erosion](int64 Value) { Value = Value >= 0 ? Value : 0; E->ErosionCycles = Value; })
 						]
 				]
+				// --- Erosion Seed Control ---
+				+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text(FText::FromString("Erosion Seed"))
+								.ToolTipText(FText::FromString("Seed used to randomize the drops. The same seed and parameters always produce the same erosion, both single-threaded and multithreaded on any number of cores."))
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+						[
+							SNew(SNumericEntryBox<int32>)
+								.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->ErosionSeed; })
+								.OnValueChanged_Lambda([this, E = Erosion](int32 Value) { E->ErosionSeed = Value; RequestErosionPreview(); })
+						]
+				]
+				// --- Adaptive Erosion Controls ---
+				+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text(FText::FromString("Erode Until Stable"))
+								.ToolTipText(FText::FromString("Stops the erosion before the number of erosion cycles once the terrain stops changing. The erosion cycles become an upper bound."))
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+						[
+							SNew(SCheckBox)
+								.IsChecked_Lambda([E = Erosion]() { return E->bAdaptiveErosion ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+								.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bAdaptiveErosion = (State == ECheckBoxState::Checked); })
+						]
+				]
+				+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						.IsEnabled_Lambda([E = Erosion]() { return E->bAdaptiveErosion; })
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text(FText::FromString("Convergence Threshold"))
+								.ToolTipText(FText::FromString("The erosion stops once each drop changes the heights by less than this fraction of what the first drops did. Higher values stop sooner."))
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+						[
+							SNew(SNumericEntryBox<float>)
+								.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->ConvergenceThreshold; })
+								.OnValueChanged_Lambda([E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->ConvergenceThreshold = Value; })
+						]
+				]
+				// --- Time Budget Control ---
+				+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text(FText::FromString("Time Budget (s)"))
+								.ToolTipText(FText::FromString("Seconds the erosion may run for, 0 for no limit. The number of drops is sized from the speed measured on this machine, up to the erosion cycles, and reported at the end so the run can be reproduced at full quality. Checked between batches of drops, so it can be exceeded by a little."))
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+						[
+							SNew(SNumericEntryBox<float>)
+								.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->ErosionTimeBudget; })
+								.OnValueChanged_Lambda([E = Erosion](float Value) { Value = Value >= 0.f ? Value : 0.f; E->ErosionTimeBudget = Value; })
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(2, 0)
+						[
+							MakeTimeBudgetPresetButton(2.f)
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(2, 0)
+						[
+							MakeTimeBudgetPresetButton(10.f)
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(2, 0)
+						[
+							MakeTimeBudgetPresetButton(60.f)
+						]
+				]
 				+ SVerticalBox::Slot().AutoHeight().Padding(8, 5)
 				[
 					SNew(SSeparator)
@@ -163,6 +255,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 											set_wind:
 												// Apply the selected wind direction to erosion settings.
 												Erosion->WindDirection = Dir;
+												RequestErosionPreview();
 											})
 										[
 											// Display currently selected wind direction.
@@ -185,7 +278,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
 										[
 											SNew(SCheckBox)
-												.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bWindBias = (State == ECheckBoxState::Checked); })
+												.OnCheckStateChanged_Lambda([this, E = Erosion](ECheckBoxState State) { E->bWindBias = (State == ECheckBoxState::Checked); RequestErosionPreview(); })
 										]
 								]
 						]
@@ -248,7 +341,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<float>)
 												.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->Inertia; })
-												.OnValueChanged_Lambda([E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->Inertia = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->Inertia = Value; RequestErosionPreview(); })
 										]
 								]
 								// Capacity Parameter (sediment transport capacity).
@@ -265,7 +358,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<int32>)
 												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->Capacity; })
-												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->Capacity = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->Capacity = Value; RequestErosionPreview(); })
 										]
 								]
 								// Minimal Slope Parameter.
@@ -282,7 +375,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<float>)
 												.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->MinimalSlope; })
-												.OnValueChanged_Lambda([E = Erosion](float Value) { Value = Value >= 0.f ? Value : 0.f; E->MinimalSlope = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](float Value) { Value = Value >= 0.f ? Value : 0.f; E->MinimalSlope = Value; RequestErosionPreview(); })
 										]
 								]
 								// Deposition Speed Parameter (0.0 - 1.0).
@@ -299,7 +392,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<float>)
 												.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->DepositionSpeed; })
-												.OnValueChanged_Lambda([E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->DepositionSpeed = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->DepositionSpeed = Value; RequestErosionPreview(); })
 										]
 								]
 								// Erosion Speed Parameter (0.0 - 1.0).
@@ -316,7 +409,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<float>)
 												.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->ErosionSpeed; })
-												.OnValueChanged_Lambda([E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->ErosionSpeed = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->ErosionSpeed = Value; RequestErosionPreview(); })
 										]
 								]
 								// Gravity Parameter.
@@ -333,7 +426,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<int32>)
 												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->Gravity; })
-												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->Gravity = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->Gravity = Value; RequestErosionPreview(); })
 										]
 								]
 								// Evaporation Parameter (0.0 - 1.0).
@@ -350,7 +443,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<float>)
 												.Value_Lambda([E = Erosion]()-> TOptional<float> { return E->Evaporation; })
-												.OnValueChanged_Lambda([E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->Evaporation = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->Evaporation = Value; RequestErosionPreview(); })
 										]
 								]
 								// Max Path Parameter (droplet lifetime in steps).
@@ -367,7 +460,7 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<int32>)
 												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->MaxPath; })
-												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->MaxPath = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->MaxPath = Value; RequestErosionPreview(); })
 										]
 								]
 								// Erosion Radius Parameter (affects smoothing of erosion effects).
@@ -384,7 +477,217 @@ void SErosionPanel::Construct(const FArguments& Args)
 										[
 											SNew(SNumericEntryBox<int32>)
 												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->ErosionRadius; })
-												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->ErosionRadius = Value; })
+												.OnValueChanged_Lambda([this, E = Erosion](int32 Value) { Value = Value >= 0 ? Value : 0; E->ErosionRadius = Value; RequestErosionPreview(); })
+										]
+								]
+								// Multithreaded Erosion Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Multithreaded"))
+												.ToolTipText(FText::FromString("Simulates the drops on all the available cores. The heightmap is split into tiles and non-adjacent tiles are eroded at the same time. Drops are kept close to their own tile, so the result is slightly different from the single-threaded simulation."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsChecked_Lambda([E = Erosion]() { return E->bParallelErosion ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bParallelErosion = (State == ECheckBoxState::Checked); })
+										]
+								]
+								// Tile Size Parameter (only used by the multithreaded erosion).
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Tile Size"))
+												.ToolTipText(FText::FromString("Side, in vertices, of the tiles used by the multithreaded erosion. Smaller tiles mean more parallel work but shorter drop paths; it is raised automatically to at least four times the erosion radius."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<int32>)
+												.IsEnabled_Lambda([E = Erosion]() { return E->bParallelErosion; })
+												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->ParallelTileSize; })
+												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = Value >= 1 ? Value : 1; E->ParallelTileSize = Value; })
+										]
+								]
+								// Vectorized Erosion Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Vectorized"))
+												.ToolTipText(FText::FromString("Advances four drops at a time using SIMD instructions. Drops of the same batch move in lockstep, so the result is slightly different from the one-at-a-time simulation, but it stays reproducible for a given seed."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsChecked_Lambda([E = Erosion]() { return E->bVectorizedErosion ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bVectorizedErosion = (State == ECheckBoxState::Checked); })
+										]
+								]
+								// Stratified Spawn Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Stratified Spawn"))
+												.ToolTipText(FText::FromString("Spawns the drops once in every 8x8 cell of the heightmap before starting over, walking the cells along a Z-order curve. Coverage is more even than with purely random spawns, so fewer erosion cycles give the same result, and consecutive drops work on nearby memory."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsChecked_Lambda([E = Erosion]() { return E->bStratifiedSpawn ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([this, E = Erosion](ECheckBoxState State) { E->bStratifiedSpawn = (State == ECheckBoxState::Checked); RequestErosionPreview(); })
+										]
+								]
+								// Importance Spawn Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Importance Spawn"))
+												.ToolTipText(FText::FromString("Spawns the drops mostly where they erode the most, on steep slopes and along drainage lines, and rarely on flat areas. Each drop carries water in proportion to how unlikely its spawn was, which roughly compensates for the uneven spawn; the result is close to, but not the same as, the uniform spawn's. Only available with the single-threaded, in-core erosion; overrides the stratified spawn."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsEnabled_Lambda([E = Erosion]() { return !E->bParallelErosion && !E->bOutOfCoreErosion; })
+												.IsChecked_Lambda([E = Erosion]() { return E->bImportanceSpawn && !E->bParallelErosion && !E->bOutOfCoreErosion ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([this, E = Erosion](ECheckBoxState State) { E->bImportanceSpawn = (State == ECheckBoxState::Checked); RequestErosionPreview(); })
+										]
+								]
+								// Multiresolution Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Multiresolution"))
+												.ToolTipText(FText::FromString("Simulates most of the drops on a downsampled heightmap, where each drop covers more ground, then refines the details at full resolution with the rest. Large valleys and fans form for a fraction of the time on 2k and larger heightmaps."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsChecked_Lambda([E = Erosion]() { return E->bMultiresolutionErosion ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bMultiresolutionErosion = (State == ECheckBoxState::Checked); })
+										]
+								]
+								// Multiresolution Levels Parameter (1 - 4).
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										.IsEnabled_Lambda([E = Erosion]() { return E->bMultiresolutionErosion; })
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Multiresolution Levels"))
+												.ToolTipText(FText::FromString("Number of times the heightmap is halved for the coarse pass. Each level makes the coarse pass about 8 times cheaper and its features coarser."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<int32>)
+												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->MultiresolutionLevels; })
+												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = FMath::Clamp(Value, 1, 4); E->MultiresolutionLevels = Value; })
+										]
+								]
+								// Multiresolution Coarse Share Parameter (0.0 - 1.0).
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										.IsEnabled_Lambda([E = Erosion]() { return E->bMultiresolutionErosion; })
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Coarse Share"))
+												.ToolTipText(FText::FromString("Share of the erosion cycles simulated on the downsampled heightmap, the rest refines it at full resolution."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<float>)
+												.Value_Lambda([E = Erosion]() -> TOptional<float> { return E->MultiresolutionCoarseShare; })
+												.OnValueChanged_Lambda([E = Erosion](float Value) { Value = FMath::Clamp(Value, 0.f, 1.f); E->MultiresolutionCoarseShare = Value; })
+										]
+								]
+								// Grid Block Size Parameter.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Grid Block Size"))
+												.ToolTipText(FText::FromString("Stores the heightmap in square blocks of this side (8 or 16 are good values) while eroding, so the cells around a drop share fewer cache lines. 0 keeps the heightmap row by row. The result does not change. Run \"DropByDrop.BenchmarkErosion\" in the console to compare the layouts on this machine."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<int32>)
+												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->GridBlockSize; })
+												// Clamp between 0 (rows) and 64.
+												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = FMath::Clamp(Value, 0, 64); E->GridBlockSize = Value; })
+										]
+								]
+								// Out-Of-Core Erosion Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Out-Of-Core"))
+												.ToolTipText(FText::FromString("Erodes a copy of the heightmap stored on disk in tiles, keeping only the tiles around the drops in memory. Meant for very large heightmaps; drops are simulated tile by tile on a single thread and kept close to their own tile, like in the multithreaded erosion. While the drops run, the erosion only keeps the memory budget, one tile window and the landscape's own heights in memory; the eroded heightmap is read back in full (4 bytes per vertex) once done, and the tile file takes up to twice that on disk."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsChecked_Lambda([E = Erosion]() { return E->bOutOfCoreErosion ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bOutOfCoreErosion = (State == ECheckBoxState::Checked); })
+										]
+								]
+								// Memory Budget Parameter (only used by the out-of-core erosion).
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Memory Budget (MB)"))
+												.ToolTipText(FText::FromString("Memory the out-of-core erosion may use for the tiles it keeps loaded. A larger budget means fewer reads and writes on disk; a few tiles are always kept regardless of the budget. The full heightmap is only loaded back at the end of the erosion, on top of this budget."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<int32>)
+												.IsEnabled_Lambda([E = Erosion]() { return E->bOutOfCoreErosion; })
+												.Value_Lambda([E = Erosion]() -> TOptional<int32> { return E->OutOfCoreMemoryBudget; })
+												.OnValueChanged_Lambda([E = Erosion](int32 Value) { Value = Value >= 1 ? Value : 1; E->OutOfCoreMemoryBudget = Value; })
+										]
+								]
+								// Apply In Place Toggle.
+								+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Apply In Place"))
+												.ToolTipText(FText::FromString("Writes the eroded heights into the selected landscape instead of spawning a new one. Only the landscape components that changed are updated, so already eroded and split landscapes can be eroded again in seconds. The edit can be undone."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+										[
+											SNew(SCheckBox)
+												.IsChecked_Lambda([E = Erosion]() { return E->bApplyInPlace ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+												.OnCheckStateChanged_Lambda([E = Erosion](ECheckBoxState State) { E->bApplyInPlace = (State == ECheckBoxState::Checked); })
 										]
 								]
 						]
@@ -401,13 +704,15 @@ void SErosionPanel::Construct(const FArguments& Args)
 						[
 							SNew(SButton)
 								.Text(FText::FromString("Erode"))
-								// Only enable if landscape is valid, not already eroded, and not split into proxies.
-								.IsEnabled_Lambda([L = ActiveLandscape]()
+								// Only enable if landscape is valid and no erosion is running.
+								// A new landscape is only spawned from a landscape neither eroded nor split into proxies,
+								// while in place erosion can be applied any number of times.
+								.IsEnabled_Lambda([this, L = ActiveLandscape, E = Erosion]()
 									{
-										if (L && IsValid(*L))
+										if (!IsEroding() && L && IsValid(*L))
 										{
 											ULandscapeInfoComponent* Info = (*L)->FindComponentByClass<ULandscapeInfoComponent>();
-											return IsValid(Info) && !Info->GetIsEroded() && !Info->GetIsSplittedIntoProxies();
+											return IsValid(Info) && (E->bApplyInPlace || (!Info->GetIsEroded() && !Info->GetIsSplittedIntoProxies()));
 										}
 
 										return false;
@@ -415,6 +720,70 @@ void SErosionPanel::Construct(const FArguments& Args)
 								.OnClicked(this, &SErosionPanel::OnErodeClicked)
 						]
 				]
+				// --- Erosion Progress (only while eroding) ---
+				+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						.Visibility_Lambda([this]() { return IsEroding() ? EVisibility::Visible : EVisibility::Collapsed; })
+						+ SHorizontalBox::Slot().FillWidth(1.f).VAlign(VAlign_Center)
+						[
+							SNew(SProgressBar)
+								.Percent_Lambda([this]() -> TOptional<float> { return ErosionProgress.IsValid() ? ErosionProgress->GetFraction() : 0.f; })
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+						[
+							SNew(SButton)
+								.Text(FText::FromString("Cancel"))
+								.IsEnabled_Lambda([this]() { return IsEroding() && !ErosionProgress->IsCancelRequested(); })
+								.OnClicked(this, &SErosionPanel::OnCancelClicked)
+						]
+				]
+				// --- Last Erosion Report (drops simulated and time taken) ---
+				+ SVerticalBox::Slot().AutoHeight().HAlign(HAlign_Center).Padding(5)
+				[
+					SNew(SHorizontalBox)
+						.Visibility_Lambda([this]() { return !IsEroding() && !LastErosionReport.IsEmpty() ? EVisibility::Visible : EVisibility::Collapsed; })
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text_Lambda([this]() { return FText::FromString(LastErosionReport); })
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+						[
+							SNew(SButton)
+								.Text(FText::FromString("Reproduce"))
+								.ToolTipText(FText::FromString("Sets the erosion cycles to the drops of the last erosion and turns off its time budget and early stop, so eroding again with the same seed gives the same result at full quality."))
+								.OnClicked(this, &SErosionPanel::OnReproduceClicked)
+						]
+				]
+				// --- Live Preview ---
+				+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text(FText::FromString("Live Preview"))
+								.ToolTipText(FText::FromString("Erodes a 128x128 copy of the active heightmap in background whenever an erosion parameter changes, and shows it shaded below. The preview always uses a small number of drops, so it shows the character of the parameters rather than the final landscape."))
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+						[
+							SNew(SCheckBox)
+								.IsChecked_Lambda([this]() { return bLivePreview ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+								.OnCheckStateChanged_Lambda([this](ECheckBoxState State) { bLivePreview = (State == ECheckBoxState::Checked); RequestErosionPreview(); })
+						]
+				]
+				+ SVerticalBox::Slot().AutoHeight().HAlign(HAlign_Center).Padding(5)
+				[
+					SNew(SBox)
+						.Visibility_Lambda([this]() { return bLivePreview && PreviewTexture.IsValid() ? EVisibility::Visible : EVisibility::Collapsed; })
+						.WidthOverride(EROSION_PREVIEW_DISPLAY_SIZE)
+						.HeightOverride(EROSION_PREVIEW_DISPLAY_SIZE)
+						[
+							SNew(SImage)
+								.Image(PreviewBrush.Get())
+						]
+				]
 				+ SVerticalBox::Slot().AutoHeight().Padding(8, 5)
 				[
 					SNew(SSeparator)
@@ -453,20 +822,199 @@ void SErosionPanel::BuildWindDirections()
 /**
  * Handles the click event for the "Erode" button.
  *
- * Triggers the erosion generation process on the active landscape using
- * the current erosion settings. Note: Pointer safety is guaranteed by
- * the button's "IsEnabled" lambda which validates the landscape before enabling.
+ * Starts the erosion of the active landscape on a background task using
+ * a copy of the current erosion settings, so the editor stays usable meanwhile.
+ * Note: Pointer safety is guaranteed by the button's "IsEnabled" lambda
+ * which validates the landscape before enabling.
  */
 FReply SErosionPanel::OnErodeClicked()
 {
+	ErosionProgress = MakeShared<FErosionProgress>();
+
+	// The panel may be closed before the erosion ends.
+	TWeakPtr<SErosionPanel> WeakPanel = SharedThis(this);
+	TSharedRef<FErosionProgress> Progress = ErosionProgress.ToSharedRef();
+
+	auto OnCompleted = [WeakPanel, Progress](bool bSuccess)
+		{
+			// Drops actually simulated, fewer than the erosion cycles if an adaptive erosion stopped early.
+			const int64 SimulatedDrops = Progress->SimulatedDrops.load(std::memory_order_relaxed);
+			const double ElapsedSeconds = Progress->ElapsedSeconds.load(std::memory_order_relaxed);
+			const TCHAR* StopReason = Progress->bConverged.load(std::memory_order_relaxed) ? TEXT(", converged")
+				: Progress->bOutOfTime.load(std::memory_order_relaxed) ? TEXT(", time budget reached") : TEXT(EMPTY_STRING);
+
+			const FString Report = FString::Printf(TEXT("%lld drops in %.2f s%s"), SimulatedDrops, ElapsedSeconds, StopReason);
+
+			if (TSharedPtr<SErosionPanel> Panel = WeakPanel.Pin())
+			{
+				// In place erosion changes the heights the preview was taken from.
+				Panel->PreviewLandscape.Reset();
+				Panel->ErosionProgress.Reset();
+				Panel->LastErosionReport = bSuccess && !Progress->IsCancelRequested() ? FString::Printf(TEXT("Last erosion: %s."), *Report) : FString();
+				Panel->LastSimulatedDrops = SimulatedDrops;
+			}
+
+			if (Progress->IsCancelRequested())
+			{
+				UDropByDropNotifications::ShowWarningNotification("Erosion generation cancelled.");
+				return;
+			}
+
+			if (!bSuccess)
+			{
+				UDropByDropNotifications::ShowErrorNotification("Erosion generation failed!");
+				return;
+			}
+
+			UDropByDropNotifications::ShowSuccessNotification(FString::Printf(TEXT("Erosion generation completed successfully (%s)!"), *Report));
+		};
+
 	// No pointer safety needed, this button is disabled if no landscape is selected.
-	if (!UPipelineLibrary::GenerateErosion(*ActiveLandscape, *Erosion))
+	if (!UPipelineLibrary::GenerateErosionAsync(*ActiveLandscape, *Erosion, Progress, MoveTemp(OnCompleted)))
 	{
+		ErosionProgress.Reset();
 		UDropByDropNotifications::ShowErrorNotification("Erosion generation failed!");
-		return FReply::Handled();
 	}
 
-	UDropByDropNotifications::ShowSuccessNotification("Erosion generation completed successfully!");
+	return FReply::Handled();
+}
+
+/**
+ * Handles the click event for the "Cancel" button.
+ *
+ * Asks the running erosion to stop; the simulation checks the request after
+ * every batch of drops and the completion callback resets the panel.
+ */
+FReply SErosionPanel::OnCancelClicked()
+{
+	if (IsEroding())
+	{
+		ErosionProgress->bCancelRequested.store(true, std::memory_order_relaxed);
+	}
+
+	return FReply::Handled();
+}
+
+/**
+ * Handles the click event for the "Reproduce" button.
+ *
+ * Drops are keyed on their global index, so the same seed and number of drops
+ * give the same erosion whether or not a time budget stopped the first run.
+ */
+FReply SErosionPanel::OnReproduceClicked()
+{
+	Erosion->ErosionCycles = LastSimulatedDrops;
+	Erosion->ErosionTimeBudget = 0.f;
+	Erosion->bAdaptiveErosion = false;
 
 	return FReply::Handled();
+}
+
+/**
+ * Creates a button labelled with its time budget, setting it on click.
+ */
+TSharedRef<SWidget> SErosionPanel::MakeTimeBudgetPresetButton(const float Seconds)
+{
+	return SNew(SButton)
+		.Text(FText::FromString(FString::Printf(TEXT("%g s"), Seconds)))
+		.OnClicked_Lambda([E = Erosion, Seconds]() { E->ErosionTimeBudget = Seconds; return FReply::Handled(); });
+}
+
+/**
+ * Cancels the running preview right away: its result would be outdated by the edit.
+ */
+void SErosionPanel::RequestErosionPreview()
+{
+	if (!bLivePreview)
+	{
+		return;
+	}
+
+	if (PreviewProgress.IsValid())
+	{
+		PreviewProgress->bCancelRequested.store(true, std::memory_order_relaxed);
+		PreviewProgress.Reset();
+	}
+
+	PreviewRequestTime = FSlateApplication::Get().GetCurrentTime();
+
+	if (!PreviewTimer.IsValid())
+	{
+		PreviewTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SErosionPanel::UpdateErosionPreview));
+	}
+}
+
+/**
+ * Ticks every frame while a preview is pending, so a slider being dragged only starts one preview when released or paused.
+ */
+EActiveTimerReturnType SErosionPanel::UpdateErosionPreview(double CurrentTime, float DeltaTime)
+{
+	if (CurrentTime - PreviewRequestTime < EROSION_PREVIEW_DELAY)
+	{
+		return EActiveTimerReturnType::Continue;
+	}
+
+	PreviewTimer.Reset();
+	StartErosionPreview();
+
+	return EActiveTimerReturnType::Stop;
+}
+
+/**
+ * The heights of the active landscape are downsampled once, then every preview erodes a copy of them.
+ */
+void SErosionPanel::StartErosionPreview()
+{
+	if (PreviewProgress.IsValid())
+	{
+		PreviewProgress->bCancelRequested.store(true, std::memory_order_relaxed);
+		PreviewProgress.Reset();
+	}
+
+	ALandscape* SourceLandscape = ActiveLandscape ? ActiveLandscape->Get() : nullptr;
+	if (!bLivePreview || !IsValid(SourceLandscape))
+	{
+		return;
+	}
+
+	if (PreviewLandscape.Get() != SourceLandscape)
+	{
+		if (!UPipelineLibrary::CreateErosionPreviewHeights(SourceLandscape, PreviewHeights, PreviewSize))
+		{
+			return;
+		}
+
+		PreviewLandscape = SourceLandscape;
+	}
+
+	PreviewProgress = MakeShared<FErosionProgress>();
+
+	// The panel may be closed before the preview ends.
+	TWeakPtr<SErosionPanel> WeakPanel = SharedThis(this);
+
+	UPipelineLibrary::GenerateErosionPreviewAsync(PreviewHeights, PreviewSize, *Erosion, PreviewProgress.ToSharedRef(), [WeakPanel, Size = PreviewSize](TArray<FColor>&& Pixels)
+		{
+			TSharedPtr<SErosionPanel> Panel = WeakPanel.Pin();
+			if (!Panel.IsValid())
+			{
+				return;
+			}
+
+			Panel->PreviewProgress.Reset();
+			Panel->PreviewTexture.Reset(UPipelineLibrary::CreateErosionPreviewTexture(Pixels, Size));
+
+			if (Panel->PreviewTexture.IsValid())
+			{
+				Panel->PreviewBrush->SetResourceObject(Panel->PreviewTexture.Get());
+				Panel->PreviewBrush->ImageSize = FVector2D(Size.X, Size.Y);
+			}
+		});
+}
+
+/**
+ * Returns whether an erosion started from this panel is still running.
+ */
+bool SErosionPanel::IsEroding() const
+{
+	return ErosionProgress.IsValid();
 }
\ No newline at end of file
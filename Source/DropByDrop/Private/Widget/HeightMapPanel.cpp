@@ -10,6 +10,9 @@
 
 #define EMPTY_STRING ""
 #define DEFAULT_PRESET_INDEX 1 // "Medium" preset selected by default.
+#define MIN_HEIGHTMAP_SIZE 2
+#define MAX_HEIGHTMAP_SIZE 8161 // Largest resolution a landscape can be imported at.
+#define MAX_EXPORT_SCALE 8 // Largest resolution multiplier of the exported RAW heightmaps.
 
 #pragma region Presets
 /**
@@ -77,7 +80,8 @@ void SHeightMapPanel::ApplyPreset(const FHeightMapGenerationSettings& Preset)
 	Heightmap->Persistence = Preset.Persistence;
 	Heightmap->Lacunarity = Preset.Lacunarity;
 	Heightmap->InitialScale = Preset.InitialScale;
-	Heightmap->Size = Preset.Size;
+	Heightmap->SizeX = Preset.SizeX;
+	Heightmap->SizeY = Preset.SizeY;
 	Heightmap->MaxHeightDifference = Preset.MaxHeightDifference;
 }
 
@@ -259,6 +263,24 @@ void SHeightMapPanel::Construct(const FArguments& Args)
 						]
 				]
 
+			// --- Vectorized Noise Checkbox ---
+			+ SVerticalBox::Slot().AutoHeight().Padding(5)
+				[
+					SNew(SHorizontalBox)
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+						[
+							SNew(STextBlock)
+								.Text(FText::FromString("Vectorized Noise"))
+								.ToolTipText(FText::FromString("Whether the Perlin noise is evaluated four points at a time with SIMD instructions. Faster on large heightmaps; the same seed gives the same terrain as the standard noise, up to single precision rounding."))
+						]
+						+ SHorizontalBox::Slot().AutoWidth().Padding(8, 0)
+						[
+							SNew(SCheckBox)
+								.IsChecked_Lambda([this]() { return Heightmap->bVectorizedNoise ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+								.OnCheckStateChanged_Lambda([this](ECheckBoxState State) { Heightmap->bVectorizedNoise = (State == ECheckBoxState::Checked); })
+						]
+				]
+
 			+ SVerticalBox::Slot().AutoHeight().Padding(8, 5)
 				[
 					SNew(SSeparator)
@@ -365,22 +387,59 @@ void SHeightMapPanel::Construct(const FArguments& Args)
 										]
 								]
 
-							// Size Parameter: Heightmap resolution.
+							// Size X Parameter: Heightmap width.
+							+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Size X"))
+												.ToolTipText(FText::FromString("The width of the heightmap in pixels. When the landscape is created, the heightmap is resampled to the nearest valid landscape resolution (e.g. 505, 1009, 2017, 4033, 8129)."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<uint32>)
+												.Value_Lambda([this]() -> TOptional<uint32> { return Heightmap->SizeX; })
+												// Clamp between the smallest and the largest landscape resolution.
+												.OnValueChanged_Lambda([this](uint32 Value) { Value = FMath::Clamp(Value, MIN_HEIGHTMAP_SIZE, MAX_HEIGHTMAP_SIZE); Heightmap->SizeX = Value; })
+										]
+								]
+
+							// Size Y Parameter: Heightmap height.
+							+ SVerticalBox::Slot().AutoHeight().Padding(2)
+								[
+									SNew(SHorizontalBox)
+										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
+										[
+											SNew(STextBlock)
+												.Text(FText::FromString("Size Y"))
+												.ToolTipText(FText::FromString("The height of the heightmap in pixels. When the landscape is created, the heightmap is resampled to the nearest valid landscape resolution (e.g. 505, 1009, 2017, 4033, 8129)."))
+										]
+										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
+										[
+											SNew(SNumericEntryBox<uint32>)
+												.Value_Lambda([this]() -> TOptional<uint32> { return Heightmap->SizeY; })
+												// Clamp between the smallest and the largest landscape resolution.
+												.OnValueChanged_Lambda([this](uint32 Value) { Value = FMath::Clamp(Value, MIN_HEIGHTMAP_SIZE, MAX_HEIGHTMAP_SIZE); Heightmap->SizeY = Value; })
+										]
+								]
+
+							// Export Scale Parameter: Resolution multiplier of the RAW export.
 							+ SVerticalBox::Slot().AutoHeight().Padding(2)
 								[
 									SNew(SHorizontalBox)
 										+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center)
 										[
 											SNew(STextBlock)
-												.Text(FText::FromString("Size"))
-												.ToolTipText(FText::FromString("Represents the resolution of the heightmap, defining both width and height simultaneously. The maximum supported value is 505 pixels."))
+												.Text(FText::FromString("Export Scale"))
+												.ToolTipText(FText::FromString("Resolution multiplier of the heightmap exported as a RAW file. The terrain keeps its shape with more detail, e.g. a 2017x2017 heightmap exported at scale 8 gives a 16129x16129 file, generated in bands with bounded memory."))
 										]
 										+ SHorizontalBox::Slot().AutoWidth().Padding(5, 0)
 										[
 											SNew(SNumericEntryBox<uint32>)
-												.Value_Lambda([this]() -> TOptional<uint32> { return Heightmap->Size; })
-												// Clamp between 1px and 505px.
-												.OnValueChanged_Lambda([this](uint32 Value) { Value = FMath::Clamp(Value, 1, 505); Heightmap->Size = Value; })
+												.Value_Lambda([this]() -> TOptional<uint32> { return Heightmap->ExportScale; })
+												.OnValueChanged_Lambda([this](uint32 Value) { Value = FMath::Clamp(Value, 1u, static_cast<uint32>(MAX_EXPORT_SCALE)); Heightmap->ExportScale = Value; })
 										]
 								]
 
@@ -419,6 +478,13 @@ void SHeightMapPanel::Construct(const FArguments& Args)
 								.Text(FText::FromString("Create HeightMap"))
 								.OnClicked(this, &SHeightMapPanel::OnCreateHeightmapClicked)
 						]
+						+ SHorizontalBox::Slot().AutoWidth().VAlign(VAlign_Center).Padding(8, 0)
+						[
+							SNew(SButton)
+								.Text(FText::FromString("Export RAW"))
+								.ToolTipText(FText::FromString("Generates the heightmap at \"Export Scale\" times its resolution straight into a 16-bit RAW (.r16) file, which the landscape editor can import. A non-square heightmap also gets a \".size\" file next to it, which lets this plugin import it back."))
+								.OnClicked(this, &SHeightMapPanel::OnExportHeightmapClicked)
+						]
 				]
 
 			+ SVerticalBox::Slot().AutoHeight().Padding(8, 5)
@@ -500,6 +566,41 @@ FReply SHeightMapPanel::OnCreateHeightmapClicked()
 	return FReply::Handled();
 }
 
+/**
+ * Handles the "Export RAW" button click event.
+ * Asks for a file path and streams the heightmap into it band by band, so the
+ * exported resolution is limited by the disk rather than the memory.
+ */
+FReply SHeightMapPanel::OnExportHeightmapClicked()
+{
+	if (!Heightmap.IsValid())
+	{
+		UDropByDropNotifications::ShowErrorNotification("Unable to export the heightmap!");
+		UE_LOG(LogDropByDropHeightmap, Error, TEXT("The \"Heightmap\" resource is invalid!"));
+		return FReply::Handled();
+	}
+
+	FString FilePath;
+	if (!UPipelineLibrary::SaveHeightmapFileDialog(FilePath))
+	{
+		return FReply::Handled();
+	}
+
+	// Scaling the quads rather than the vertices keeps valid landscape resolutions valid.
+	const int32 Scale = FMath::Max<int32>(Heightmap->ExportScale, 1);
+	const FIntPoint Size((Heightmap->SizeX - 1) * Scale + 1, (Heightmap->SizeY - 1) * Scale + 1);
+
+	if (!UPipelineLibrary::GenerateHeightMapToFile(*Heightmap, Size, FilePath))
+	{
+		UDropByDropNotifications::ShowErrorNotification("Failed to export the heightmap!");
+		return FReply::Handled();
+	}
+
+	UDropByDropNotifications::ShowSuccessNotification(FString::Printf(TEXT("%dx%d heightmap exported successfully!"), Size.X, Size.Y));
+
+	return FReply::Handled();
+}
+
 /**
  * Handles the "Import External Heightmap" button click event.
  * Opens a file dialog allowing the user to select an external heightmap
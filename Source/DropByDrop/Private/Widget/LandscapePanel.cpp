@@ -220,6 +220,16 @@ void SLandscapePanel::Construct(const FArguments& Args)
 								.Text(FText::FromString("Split in Proxies"))
 								.OnClicked(this, &SLandscapePanel::OnSplitInProxiesClicked)
 						]
+						// "Export Heightmap" button.
+						// Only enabled when a valid landscape is selected.
+						+SHorizontalBox::Slot().AutoWidth()
+						[
+							SNew(SButton)
+								.IsEnabled_Lambda([L = ActiveLandscape]() { return L && IsValid(*L); })
+								.Text(FText::FromString("Export Heightmap"))
+								.ToolTipText(FText::FromString("Saves the heightmap of the selected landscape, eroded or not, as a 16-bit RAW (.r16) file. A non-square heightmap also gets a \".size\" file next to it, which lets this plugin import it back."))
+								.OnClicked(this, &SLandscapePanel::OnExportHeightmapClicked)
+						]
 				]
 
 			// Additional visual separators for spacing at bottom.
@@ -291,6 +301,32 @@ FReply SLandscapePanel::OnSplitInProxiesClicked()
 
 	UDropByDropNotifications::ShowSuccessNotification(TEXT("Landscape successfully split into proxies!"));
 
+	// Return Handled to indicate the UI event was processed.
+	return FReply::Handled();
+}
+
+/**
+ * Event handler for the "Export Heightmap" button.
+ *
+ * Asks for a file path and writes the stored heightmap of the active landscape into it
+ * as a 16-bit RAW file, which can be imported back without going through a texture.
+ */
+FReply SLandscapePanel::OnExportHeightmapClicked()
+{
+	FString FilePath;
+	if (!UPipelineLibrary::SaveHeightmapFileDialog(FilePath))
+	{
+		return FReply::Handled();
+	}
+
+	if (!UPipelineLibrary::ExportLandscapeHeightmap(*ActiveLandscape, FilePath))
+	{
+		UDropByDropNotifications::ShowErrorNotification(TEXT("Failed to export the heightmap!"));
+		return FReply::Handled();
+	}
+
+	UDropByDropNotifications::ShowSuccessNotification(TEXT("Heightmap exported successfully!"));
+
 	// Return Handled to indicate the UI event was processed.
 	return FReply::Handled();
 }
\ No newline at end of file
@@ -320,16 +320,16 @@ FReply SRootPanel::OnActionImportAndCreateLandscapeExternal()
 
 	UDropByDropNotifications::ShowSuccessNotification(TEXT("Heightmap successfully imported and landscape successfully created!"));
 
-	// Update preview to show imported heightmap.
-	RefreshRightPreview();
+	// Update preview to show imported heightmap; RAW imports save none, so the saved one would be stale.
+	RefreshRightPreview(!UPipelineLibrary::IsRawHeightmapFile(External->LastPNGPath));
 
 	return FReply::Handled();
 }
 
-void SRootPanel::RefreshRightPreview()
+void SRootPanel::RefreshRightPreview(const bool bLoadSavedHeightmap)
 {
 	// Load heightmap texture from saved asset path.
-	UTexture2D* LoadedTexture = Cast<UTexture2D>(StaticLoadObject(UTexture2D::StaticClass(), nullptr, TEXT(HEIGHTMAP_TEXTURE_PATH)));
+	UTexture2D* LoadedTexture = bLoadSavedHeightmap ? Cast<UTexture2D>(StaticLoadObject(UTexture2D::StaticClass(), nullptr, TEXT(HEIGHTMAP_TEXTURE_PATH))) : nullptr;
 	RightPreviewTexture.Reset(LoadedTexture);
 
 	// Update slate brush with loaded texture.
@@ -343,7 +343,7 @@ void SRootPanel::RefreshRightPreview()
 		}
 		else
 		{
-			// Clear brush if texture failed to load.
+			// Clear brush if texture failed to load or was not asked for.
 			RightPreviewBrush->SetResourceObject(nullptr);
 			RightPreviewBrush->ImageSize = FVector2D(0, 0);
 		}
@@ -44,6 +44,12 @@ public: // Methods.
 	 */
 	FHeightMapGenerationSettings& GetHeightMapSettings();
 
+	/**
+	 * Gets a read-only reference to the heightmap generation settings.
+	 * @return Reference to the heightmap generation settings.
+	 */
+	const FHeightMapGenerationSettings& GetHeightMapSettings() const;
+
 	/**
 	 * Sets new settings for heightmap generation.
 	 * @param NewHeightMapSettings - The new settings to apply.
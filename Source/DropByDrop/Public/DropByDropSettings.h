@@ -44,14 +44,23 @@ struct FHeightMapGenerationSettings
 	/** Starting scale of the noise pattern. */
 	float InitialScale = 1.8f;
 
-	/** Size of the heightmap grid. */
-	uint32 Size = 505;
+	/** Width of the heightmap grid. */
+	uint32 SizeX = 505;
+
+	/** Height of the heightmap grid. */
+	uint32 SizeY = 505;
 
 	/** Maximum allowed height difference for terrain normalization. */
 	float MaxHeightDifference = 1.0f;
 
 	/** If true, generates a new random seed each time. */
 	bool bRandomizeSeed = false;
+
+	/** If true, the noise is evaluated four points at a time with SIMD instructions. Gives the terrain of the scalar noise, in single precision. */
+	bool bVectorizedNoise = false;
+
+	/** Resolution multiplier of the heightmaps exported as RAW files, which are generated in bands and not limited by the landscape import size. */
+	uint32 ExportScale = 1;
 };
 
 /**
@@ -65,7 +74,7 @@ struct FExternalHeightMapSettings
 {
 	GENERATED_BODY()
 
-	/** Path to the last loaded PNG heightmap file. */
+	/** Path to the last loaded heightmap file (PNG or 16-bit RAW). */
 	FString LastPNGPath;
 
 	/** Horizontal (X-axis) scaling factor for the imported heightmap. */
@@ -118,6 +127,18 @@ struct FErosionSettings
 	/** Total number of water droplet simulations to run. */
 	int64 ErosionCycles = 100000;
 
+	/** Seed of the droplets' random streams. The same seed always produces the same erosion. */
+	int32 ErosionSeed = 0;
+
+	/** If true, the erosion stops before "ErosionCycles" droplets once the terrain stops changing. */
+	bool bAdaptiveErosion = false;
+
+	/** Adaptive erosion stops once the mean height change per droplet falls below this fraction of the one of the first droplets. */
+	float ConvergenceThreshold = 0.05f;
+
+	/** Seconds the erosion may run for, stopping before "ErosionCycles" droplets if needed; 0 for no limit. The droplets actually simulated are reported back. */
+	float ErosionTimeBudget = 0.f;
+
 	/** How much the droplet retains its direction. */
 	float Inertia = 0.3f;
 
@@ -139,6 +160,21 @@ struct FErosionSettings
 	/** Rate at which water evaporates, reducing the droplet's volume. */
 	float Evaporation = 0.02f;
 
+	/** If true, droplets are spawned once in every small cell of the heightmap per pass, visiting the cells along a Z-order curve. */
+	bool bStratifiedSpawn = false;
+
+	/** If true, the single-threaded erosion spawns droplets mostly on steep slopes and drainage lines, weighting their water to roughly compensate. Ignored by the parallel and out-of-core erosions; takes precedence over the stratified spawn. */
+	bool bImportanceSpawn = false;
+
+	/** If true, most droplets are simulated on a downsampled copy of the heightmap, then a few refine it at full resolution. Ignored by the out-of-core erosion. */
+	bool bMultiresolutionErosion = false;
+
+	/** Number of times the heightmap is halved for the coarse pass of the multiresolution erosion. */
+	int32 MultiresolutionLevels = 2;
+
+	/** Share of "ErosionCycles" simulated by the coarse pass of the multiresolution erosion, the rest refines at full resolution. */
+	float MultiresolutionCoarseShare = 0.8f;
+
 	/** Maximum number of steps a single droplet can take before terminating. */
 	int32 MaxPath = 64;
 
@@ -150,6 +186,30 @@ struct FErosionSettings
 
 	/** Compass direction for wind bias (see "EWindDirection" enum). */
 	uint8 WindDirection = 0;
+
+	/** If true, droplets are simulated in parallel on non-adjacent tiles of the heightmap. */
+	bool bParallelErosion = false;
+
+	/** Side, in vertices, of the tiles used by the parallel erosion. */
+	int32 ParallelTileSize = 64;
+
+	/** If true, droplets are advanced in SIMD batches instead of one at a time. */
+	bool bVectorizedErosion = false;
+
+	/** Side, in vertices, of the square blocks the simulated grid is stored in (rounded up to a power of two, below 2 stores it row by row). */
+	int32 GridBlockSize = 0;
+
+	/** If true, the heights are paged from a tile file on disk during the erosion, bounding its memory use to the budget until the eroded heights are read back. */
+	bool bOutOfCoreErosion = false;
+
+	/** Side, in vertices, of the tiles paged by the out-of-core erosion. */
+	int32 OutOfCoreTileSize = 256;
+
+	/** Memory, in megabytes, the out-of-core erosion keeps resident for its tiles. */
+	int32 OutOfCoreMemoryBudget = 256;
+
+	/** If true, the eroded heights are written into the eroded landscape instead of spawning a new one. */
+	bool bApplyInPlace = false;
 };
 
 /**
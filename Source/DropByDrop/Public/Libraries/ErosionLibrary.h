@@ -3,11 +3,13 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include <atomic>
 #include "ErosionLibrary.generated.h"
 
 #pragma region ForwardDeclarations
 
 struct FErosionSettings;
+class IFileHandle;
 
 #pragma endregion
 
@@ -20,10 +22,10 @@ struct FErosionSettings;
 struct FDrop
 {
 	/** Current position of the drop in 2D world space. */
-	FVector2D Position;
+	FVector2f Position;
 
 	/** Movement direction of the drop in 2D world space. */
-	FVector2D Direction;
+	FVector2f Direction;
 
 	/** Current speed of the drop. */
 	float Velocity;
@@ -32,6 +34,26 @@ struct FDrop
 	float Water;
 };
 
+/**
+ * Structure-of-arrays state of the drops advanced in lockstep by the vectorized erosion kernel.
+ * Every array stores one lane per drop, so each quantity can be loaded into a single SIMD register.
+ */
+struct FDropBatch
+{
+	/** Number of drops simulated together (one per SIMD lane). */
+	static constexpr int32 NumLanes = 4;
+
+	alignas(16) float PositionX[NumLanes];
+	alignas(16) float PositionY[NumLanes];
+	alignas(16) float DirectionX[NumLanes];
+	alignas(16) float DirectionY[NumLanes];
+	alignas(16) float Velocity[NumLanes];
+	alignas(16) float Water[NumLanes];
+
+	/** Lanes holding a drop to simulate (the last batch of a run may be partially empty). */
+	bool bAlive[NumLanes];
+};
+
 /**
  * Stores the height values of all four corners of a grid cell.
  * Used for bilinear interpolation and gradient calculations.
@@ -45,15 +67,188 @@ struct FCornersHeights
 };
 
 /**
- * Enumeration indicating whether a position is within bounds or which boundary it exceeds.
- * Used to handle edge cases during erosion simulation.
+ * Layout of the padded heightmap simulated internally by the erosion.
+ * The working grid is surrounded on every side by an apron of "Padding" cells, so the kernel
+ * can read the corners of any cell and distribute deposits without checking the grid borders.
+ * The padded grid is either stored row by row or, with a "BlockShift", in square blocks stored
+ * one after the other, so the cells around a drop share far fewer cache lines.
+ */
+struct FErosionGrid
+{
+	/** Width and height of the working (unpadded) grid. */
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	/** Number of apron cells on every side of the working grid. */
+	int32 Padding = 0;
+
+	/** Width of the padded grid, that is the distance between two rows when not blocked. */
+	int32 Stride = 0;
+
+	/** Log2 of the side of the blocks, 0 if the padded grid is stored row by row. */
+	int32 BlockShift = 0;
+
+	/** Number of blocks along a row of the padded grid (only used when blocked). */
+	int32 BlocksPerRow = 0;
+
+	/** Returns the index in the padded heights of the given working grid cell. */
+	FORCEINLINE int32 GetIndex(const int32 X, const int32 Y) const
+	{
+		const int32 PaddedX = X + Padding;
+		const int32 PaddedY = Y + Padding;
+
+		if (BlockShift == 0)
+		{
+			return PaddedX + PaddedY * Stride;
+		}
+
+		const int32 BlockMask = (1 << BlockShift) - 1;
+		const int32 Block = (PaddedY >> BlockShift) * BlocksPerRow + (PaddedX >> BlockShift);
+		return (Block << (2 * BlockShift)) + ((PaddedY & BlockMask) << BlockShift) + (PaddedX & BlockMask);
+	}
+
+	/** Distance between two rows inside a block, or inside the grid when not blocked. Brush index offsets are built for it. */
+	FORCEINLINE int32 GetRowPitch() const
+	{
+		return BlockShift == 0 ? Stride : 1 << BlockShift;
+	}
+
+	/** Whether all the cells within "Radius" of the given cell lie in its block (always true when not blocked). */
+	FORCEINLINE bool IsInsideBlock(const int32 X, const int32 Y, const int32 Radius) const
+	{
+		if (BlockShift == 0)
+		{
+			return true;
+		}
+
+		const int32 BlockMask = (1 << BlockShift) - 1;
+		const int32 LocalX = (X + Padding) & BlockMask;
+		const int32 LocalY = (Y + Padding) & BlockMask;
+		return LocalX >= Radius && LocalX + Radius <= BlockMask && LocalY >= Radius && LocalY + Radius <= BlockMask;
+	}
+
+	/** Returns the indices of the cells (x, y), (x + 1, y), (x, y + 1) and (x + 1, y + 1). */
+	FORCEINLINE void GetCornerIndices(const int32 X, const int32 Y, int32& X_Y, int32& X1_Y, int32& X_Y1, int32& X1_Y1) const
+	{
+		X_Y = GetIndex(X, Y);
+
+		// Neighbours inside the same block (or row) are at a fixed distance.
+		const int32 BlockMask = (1 << BlockShift) - 1;
+		const bool bRightInside = BlockShift == 0 || ((X + Padding) & BlockMask) != BlockMask;
+		const bool bBottomInside = BlockShift == 0 || ((Y + Padding) & BlockMask) != BlockMask;
+
+		X1_Y = bRightInside ? X_Y + 1 : GetIndex(X + 1, Y);
+		X_Y1 = bBottomInside ? X_Y + GetRowPitch() : GetIndex(X, Y + 1);
+		X1_Y1 = bRightInside && bBottomInside ? X_Y1 + 1 : GetIndex(X + 1, Y + 1);
+	}
+};
+
+/**
+ * Counter-based random stream ("SplitMix64") owned by a single drop.
+ * Its state only depends on the erosion seed and on the drop index, so drop N always
+ * receives the same numbers regardless of which thread simulates it or in which order.
+ */
+struct FErosionRandomStream
+{
+	FErosionRandomStream(const int32 Seed, const int64 DropIndex);
+
+	/** Returns a random number in the [0, 1) range. */
+	float GetFraction();
+
+	/** Returns a random number in the [Min, Max) range. */
+	float FRandRange(const float Min, const float Max);
+
+	/** Returns a random integer in the [0, Max) range. */
+	int32 RandHelper(const int32 Max);
+
+private:
+	/** Advances the stream and returns the next 64 random bits. */
+	uint64 Next();
+
+	/** Current counter of the stream. */
+	uint64 State;
+};
+
+/**
+ * Temporary calculation data used while simulating a single drop.
+ * Each thread simulating drops owns its own workspace.
+ */
+struct FErosionWorkspace
+{
+	/** Indices in the padded heights (see "FErosionGrid") of cells affected by the current drop's movement. */
+	TArray<int32> Points; // pI
+
+	/** Squared weight values for affected cells based on distance from drop position. */
+	TArray<float> SquaredWeights; // wI
+
+	/** Cells of the stratified spawn, relative to "SpawnStrataBounds" and sorted along a Z-order curve. */
+	TArray<FIntPoint> SpawnStrata;
+
+	/** Spawn bounds "SpawnStrata" was built for. */
+	FIntRect SpawnStrataBounds;
+
+	/** Sum of the absolute height changes (sediment eroded plus deposited) of the drops simulated since the last reset. */
+	double HeightChange = 0.0;
+};
+
+/**
+ * Precomputed erosion brush for a given radius.
+ * Stores the integer offsets, relative to the drop cell, of every cell with a non-zero weight
+ * and their weights already normalized to sum to "1.0".
+ */
+struct FErosionBrush
+{
+	/** Erosion radius this brush was built for ("INDEX_NONE" if not built yet). */
+	int32 Radius = INDEX_NONE;
+
+	/** Row pitch of the padded grid this brush was built for (see "FErosionGrid::GetRowPitch"). */
+	int32 Stride = INDEX_NONE;
+
+	/** Offsets of the affected cells from the drop cell. */
+	TArray<FIntPoint> Offsets;
+
+	/** Same offsets, as distances between indices of the padded heights (inside a block, if the grid is blocked). */
+	TArray<int32> IndexOffsets;
+
+	/** Normalized weight of each offset. */
+	TArray<float> Weights;
+};
+
+/**
+ * Importance distribution the drops can be spawned from, built over square cells of the heightmap.
+ * Cells are sampled in constant time with Vose's alias method; the drops spawned in a cell start with
+ * more or less water than usual, which roughly compensates for the cells being picked more or less often.
  */
-enum EOutOfBoundResult : uint8
+struct FErosionSpawnDistribution
 {
-	No_Error,         // Position is within valid bounds.
-	Error_Right,      // Position exceeds right boundary.
-	Error_Down,       // Position exceeds bottom boundary.
-	Error_Right_Down  // Position exceeds both right and bottom boundaries.
+	/** Side, in vertices, of the cells. */
+	int32 CellSize = 0;
+
+	/** Number of cells along each axis. */
+	FIntPoint CellCount = FIntPoint::ZeroValue;
+
+	/** Probability of keeping a uniformly picked cell instead of taking its alias. */
+	TArray<float> Probabilities;
+
+	/** Cell taken when the uniformly picked one is rejected. */
+	TArray<int32> Aliases;
+
+	/** Water of the drops spawned in each cell: uniform probability of the cell over its importance probability. */
+	TArray<float> Weights;
+};
+
+/**
+ * State of an adaptive erosion, tracked after every batch of drops to decide whether the simulation can stop early.
+ */
+struct FErosionConvergence
+{
+	/** Time the simulation started at (see "FPlatformTime::Seconds"). */
+	double StartTime = 0.0;
+
+	/** Mean absolute height change per drop of the first batch, the reference of the later batches. */
+	double FirstChange = -1.0;
+
+	/** Exponential moving average of the mean absolute height change per drop. */
+	double SmoothedChange = 0.0;
 };
 
 /**
@@ -65,13 +260,236 @@ struct FErosionContext
 	/** Height values for each cell in the landscape grid. */
 	TArray<float> GridHeights;
 
-	/** Grid positions of cells affected by the current drop's movement. */
-	TArray<FVector2D> Points; // pI
+	/** Copy of "GridHeights" surrounded by the apron, simulated during "Erosion". */
+	TArray<float> PaddedHeights;
 
-	/** Squared weight values for affected cells based on distance from drop position. */
-	TArray<float> SquaredWeights; // wI
+	/** Layout of "PaddedHeights". */
+	FErosionGrid Grid;
+
+	/** Workspace used by the serial simulation. */
+	FErosionWorkspace Workspace;
+
+	/** Brush cached for the last simulated erosion radius. */
+	FErosionBrush Brush;
+
+	/** Importance spawn distribution of the current heights, built by the serial simulation when enabled. */
+	FErosionSpawnDistribution SpawnDistribution;
+
+	/** Convergence state of the running simulation. */
+	FErosionConvergence Convergence;
+};
+
+/**
+ * Progress of an erosion running on another thread.
+ * Written by the simulation after every batch of drops, read and cancelled from any thread.
+ */
+struct FErosionProgress
+{
+	/** Drops to simulate, set when the simulation starts. */
+	std::atomic<int64> TotalDrops = 0;
+
+	/** Drops already simulated. */
+	std::atomic<int64> SimulatedDrops = 0;
+
+	/** Set to stop the simulation at the end of the current batch of drops. */
+	std::atomic<bool> bCancelRequested = false;
+
+	/** Seconds the simulation took, set when it ends. */
+	std::atomic<double> ElapsedSeconds = 0.0;
+
+	/** Set when an adaptive simulation stopped because the heights no longer changed. */
+	std::atomic<bool> bConverged = false;
+
+	/** Set when a simulation stopped because its time budget ran out. */
+	std::atomic<bool> bOutOfTime = false;
+
+	/** Fraction of the drops already simulated, in [0, 1]. */
+	float GetFraction() const
+	{
+		const int64 Total = TotalDrops.load(std::memory_order_relaxed);
+		return Total > 0 ? static_cast<float>(static_cast<double>(SimulatedDrops.load(std::memory_order_relaxed)) / Total) : 0.f;
+	}
+
+	/** Whether the simulation has been asked to stop. */
+	bool IsCancelRequested() const
+	{
+		return bCancelRequested.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * Square region of the grid simulated by a single task of the parallel erosion.
+ * Drops spawn inside "Bounds" and are stopped as soon as they leave "DropBounds".
+ */
+struct FErosionTile
+{
+	/** Cells where the drops of this tile are spawned. */
+	FIntRect Bounds;
+
+	/** Cells the drops of this tile are allowed to reach (tile plus margin). */
+	FIntRect DropBounds;
+
+	/** Number of drops simulated in this tile during the current round. */
+	int64 NumDrops;
+
+	/** Global index of the first drop of this tile, used to key the drops' random streams. */
+	int64 FirstDrop;
+};
+
+/**
+ * Heightmap stored on disk as square tiles, paged in and out of memory while the drops move.
+ * At most "MaxResidentTiles" tiles are kept in memory: when a new one is needed, the least recently
+ * used tile is written back (if modified) and its memory reused. The file is deleted on "Close".
+ * Modified tiles are written to a second half of the file, so the heights first written stay readable.
+ */
+struct FErosionTileCache
+{
+	FErosionTileCache() = default;
+	~FErosionTileCache();
+
+	/**
+	 * Creates the tile file and sizes the cache.
+	 * @param InFilePath - Path of the tile file to create.
+	 * @param InGridSize - Width and height of the grid of heights.
+	 * @param InTileSize - Side length of each tile.
+	 * @param MemoryBudget - Bytes the resident tiles may use (at least a 3x3 block of tiles is always kept).
+	 * @return False if the file could not be created.
+	 */
+	bool Open(const FString& InFilePath, const FIntPoint& InGridSize, const int32 InTileSize, const int64 MemoryBudget);
+
+	/** Drops the resident tiles and deletes the tile file. */
+	void Close();
+
+	/**
+	 * Writes the whole grid of heights into the tile file, replacing its content.
+	 * @param Heights - Heights of the grid, row by row.
+	 * @return False if the file could not be written.
+	 */
+	bool WriteHeights(TConstArrayView<float> Heights);
+
+	/**
+	 * Reads the whole grid of heights back from the tiles.
+	 * @param OutHeights - Heights of the grid, row by row.
+	 * @return False if the file could not be read.
+	 */
+	bool ReadHeights(TArray<float>& OutHeights);
+
+	/**
+	 * Reads the heights written by "WriteHeights" back from the file, ignoring every later change.
+	 * @param OutHeights - Heights of the grid, row by row.
+	 * @return False if the file could not be read.
+	 */
+	bool ReadOriginalHeights(TArray<float>& OutHeights);
+
+	/**
+	 * Copies a region of the grid out of the tiles.
+	 * @param Region - Cells to copy, inside the grid.
+	 * @param OutHeights - Destination of the first cell of the region.
+	 * @param Stride - Distance between two rows of the destination.
+	 * @return False if a tile could not be paged in.
+	 */
+	bool ReadRegion(const FIntRect& Region, float* OutHeights, const int32 Stride);
+
+	/**
+	 * Copies a region of the grid into the tiles.
+	 * @param Region - Cells to copy, inside the grid.
+	 * @param InHeights - Source of the first cell of the region.
+	 * @param Stride - Distance between two rows of the source.
+	 * @return False if a tile could not be paged in.
+	 */
+	bool WriteRegion(const FIntRect& Region, const float* InHeights, const int32 Stride);
+
+	/** Tile requests served from memory. */
+	int64 Hits = 0;
+
+	/** Tile requests that had to read the tile file. */
+	int64 Misses = 0;
+
+private:
+	/** Tile held in memory. */
+	struct FResidentTile
+	{
+		/** Coordinates of the tile in the tile grid. */
+		FIntPoint Coordinates = FIntPoint::NoneValue;
+
+		/** Heights of the tile, row by row. */
+		TArray<float> Heights;
+
+		/** Value of "UseClock" when the tile was last requested. */
+		uint64 LastUse = 0;
+
+		/** Whether the heights differ from the ones in the file. */
+		bool bDirty = false;
+	};
+
+	/**
+	 * Returns the heights of a tile, paging it in if it is not resident.
+	 * @param Coordinates - Coordinates of the tile in the tile grid.
+	 * @param bWrite - Whether the heights are going to be modified.
+	 * @return Heights of the tile, or null if the file could not be accessed.
+	 */
+	float* GetTile(const FIntPoint& Coordinates, const bool bWrite);
+
+	/**
+	 * Writes a resident tile back to the file if it was modified.
+	 * @param Tile - Tile to write.
+	 * @return False if the file could not be written.
+	 */
+	bool StoreTile(FResidentTile& Tile);
+
+	/**
+	 * Copies a region of the grid between the tiles and a row-major buffer.
+	 * @param Region - Cells to copy, inside the grid.
+	 * @param Heights - Buffer holding the first cell of the region.
+	 * @param Stride - Distance between two rows of the buffer.
+	 * @param bWrite - True to copy into the tiles, false to copy out of them.
+	 * @return False if a tile could not be paged in.
+	 */
+	bool CopyRegion(const FIntRect& Region, float* Heights, const int32 Stride, const bool bWrite);
+
+	/**
+	 * Position of a tile in the file.
+	 * @param Coordinates - Coordinates of the tile in the tile grid.
+	 * @param bModified - True for the modified copy of the tile, false for the one written by "WriteHeights".
+	 */
+	int64 GetTileOffset(const FIntPoint& Coordinates, const bool bModified) const;
+
+	/** Handle of the tile file, open for reading and writing. */
+	TUniquePtr<IFileHandle> FileHandle;
+
+	/** Path of the tile file. */
+	FString FilePath;
+
+	/** Width and height of the grid of heights. */
+	FIntPoint GridSize = FIntPoint::ZeroValue;
+
+	/** Number of tiles along each axis. */
+	FIntPoint TileCount = FIntPoint::ZeroValue;
+
+	/** Side length of each tile. */
+	int32 TileSize = 0;
+
+	/** Maximum number of tiles kept in memory. */
+	int32 MaxResidentTiles = 0;
+
+	/** Tiles currently in memory. */
+	TArray<FResidentTile> ResidentTiles;
+
+	/** Index in "ResidentTiles" of each resident tile. */
+	TMap<FIntPoint, int32> ResidentSlots;
+
+	/** Tiles whose modified copy has been written to the file, row by row. */
+	TBitArray<> StoredTiles;
+
+	/** Incremented on every tile request, orders the resident tiles by last use. */
+	uint64 UseClock = 0;
 };
 
+/**
+ * Signature shared by all the compile-time specializations of "UErosionLibrary::SimulateDrops".
+ */
+using FSimulateDropsFunction = void (*)(TArray<float>&, FErosionWorkspace&, const FErosionBrush&, const FErosionSettings&, const FErosionGrid&, const FErosionSpawnDistribution*, const FIntRect&, const FIntRect&, const int64, const int64);
+
 #pragma endregion
 
 /**
@@ -87,24 +505,47 @@ public:
 	/**
 	 * Sets the height values in the erosion context.
 	 * @param ErosionContext - The erosion context to modify.
-	 * @param InHeights - Array of height values to assign.
+	 * @param InHeights - Array of height values to copy.
 	 */
 	static void SetHeights(FErosionContext& ErosionContext, const TArray<float>& InHeights);
 
+	/**
+	 * Sets the height values in the erosion context without copying them.
+	 * @param ErosionContext - The erosion context to modify.
+	 * @param InHeights - Array of height values to move into the context.
+	 */
+	static void SetHeights(FErosionContext& ErosionContext, TArray<float>&& InHeights);
+
 	/**
 	 * Gets the current height values from the erosion context.
 	 * @param ErosionContext - The erosion context to read from.
-	 * @return Array of height values.
+	 * @return Copy of the array of height values.
 	 */
 	static TArray<float> GetHeights(const FErosionContext& ErosionContext);
 
+	/**
+	 * Gets a read-only view of the current height values, valid until the context is modified.
+	 * @param ErosionContext - The erosion context to read from.
+	 * @return View of the height values.
+	 */
+	static TConstArrayView<float> GetHeightsView(const FErosionContext& ErosionContext);
+
+	/**
+	 * Moves the height values out of the erosion context, leaving it empty.
+	 * @param ErosionContext - The erosion context to read from.
+	 * @return Array of height values.
+	 */
+	static TArray<float> TakeHeights(FErosionContext& ErosionContext);
+
 	/**
 	 * Performs hydraulic erosion simulation on the heightmap.
 	 * @param ErosionContext - Context containing heightmap and working data.
 	 * @param ErosionSettings - Settings controlling erosion behavior.
-	 * @param GridSize - Size of the square grid of heights (width and height).
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param Progress - Optional progress updated during the simulation, which can also cancel it.
+	 * @return False if the heights are invalid or the simulation was cancelled, true otherwise.
 	 */
-	static void Erosion(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const int32 GridSize);
+	static bool Erosion(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, FErosionProgress* Progress = nullptr);
 
 	/**
 	 * Get the normalized mean wind angle from erosion settings.
@@ -121,33 +562,288 @@ public:
 	 */
 	static FVector2D GetWindUnitVectorFromAngle(const float Degrees);
 
+	/**
+	 * Times the erosion of synthetic 1k, 2k and 4k heightmaps with the row-major and the blocked grid layouts.
+	 * Bound to the "DropByDrop.BenchmarkErosion" console command.
+	 * @param Args - Optional number of drops to simulate for each run.
+	 */
+	static void BenchmarkErosion(const TArray<FString>& Args);
+
 private:
 	/**
-	 * Applies erosion effects for a single water drop simulation.
+	 * Copies the heights into the padded grid, filling the apron with the nearest border heights.
+	 * @param ErosionContext - Context containing the heights to pad.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param Padding - Number of apron cells on every side.
+	 * @param BlockShift - Log2 of the side of the blocks the padded grid is stored in, 0 to store it row by row.
+	 */
+	static void BuildPaddedGrid(FErosionContext& ErosionContext, const FIntPoint& GridSize, const int32 Padding, const int32 BlockShift);
+
+	/**
+	 * Copies the working area of the padded grid back into the heights, discarding the apron.
+	 * @param ErosionContext - Context containing the simulated padded grid.
+	 */
+	static void StitchPaddedGrid(FErosionContext& ErosionContext);
+
+	/**
+	 * Simulates all the drops one after the other on the calling thread.
+	 * @param ErosionContext - Context containing heightmap and working data.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param SimulateDropsFunction - Kernel specialization selected for the erosion settings.
+	 * @param Progress - Optional progress, updated after every batch of drops.
+	 * @return False if the simulation was cancelled.
+	 */
+	static bool ErosionSerial(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, const FSimulateDropsFunction SimulateDropsFunction, FErosionProgress* Progress);
+
+	/**
+	 * Updates the convergence of an adaptive erosion with a batch of drops and tells whether to stop.
+	 * @param Convergence - Convergence state of the simulation.
+	 * @param ErosionSettings - Settings holding the convergence threshold and the time budget.
+	 * @param HeightChange - Sum of the absolute height changes of the drops of the batch.
+	 * @param NumDrops - Number of drops in the batch.
+	 * @param Progress - Optional progress, told why the simulation stopped.
+	 * @return True if the adaptive erosion converged or the time budget ran out.
+	 */
+	static bool ShouldStopErosion(FErosionConvergence& Convergence, const FErosionSettings& ErosionSettings, const double HeightChange, const int64 NumDrops, FErosionProgress* Progress);
+
+	/**
+	 * Sizes the next batch of drops of a time-budgeted erosion from the throughput measured so far.
+	 * @param Convergence - Convergence state of the simulation, holding its start time.
+	 * @param ErosionSettings - Settings holding the time budget.
+	 * @param SimulatedDrops - Drops simulated since the start.
+	 * @param Progress - Optional progress, whose total is set to the drops the budget is expected to allow.
+	 * @return Drops of the next batch, "EROSION_PROGRESS_DROPS_PER_BATCH" without a time budget.
+	 */
+	static int64 UpdateTimeBudget(const FErosionConvergence& Convergence, const FErosionSettings& ErosionSettings, const int64 SimulatedDrops, FErosionProgress* Progress);
+
+	/**
+	 * Simulates the drops in parallel, splitting the grid into tiles processed in four colour phases.
+	 * Tiles of the same colour are never adjacent, so their drops never touch the same cells.
 	 * @param ErosionContext - Context containing heightmap and working data.
 	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param SimulateDropsFunction - Kernel specialization selected for the erosion settings.
+	 * @param Progress - Optional progress, updated after every tile.
+	 * @return False if the simulation was cancelled.
+	 */
+	static bool ErosionParallel(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, const FSimulateDropsFunction SimulateDropsFunction, FErosionProgress* Progress);
+
+	/**
+	 * Simulates the drops tile by tile on a copy of the heights paged from disk, so only a bounded part of it is in memory.
+	 * The heights of the context are released meanwhile and read back from disk once done.
+	 * @param ErosionContext - Context containing heightmap and working data.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param SimulateDropsFunction - Kernel specialization selected for the erosion settings.
+	 * @param Progress - Optional progress, updated after every tile.
+	 * @return False if the simulation was cancelled or the tile file could not be accessed.
+	 */
+	static bool ErosionOutOfCore(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, const FSimulateDropsFunction SimulateDropsFunction, FErosionProgress* Progress);
+
+	/**
+	 * Erodes the heights at their own resolution with the serial, parallel or out-of-core simulation.
+	 * @param ErosionContext - Context containing heightmap and working data.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param Progress - Optional progress, whose simulated drops are added to.
+	 * @return False if the grid is too large or the simulation was cancelled or failed.
+	 */
+	static bool ErosionPass(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, FErosionProgress* Progress);
+
+	/**
+	 * Erodes a downsampled copy of the heights with most of the drops, adds the upsampled erosion to the heights, then refines them at full resolution.
+	 * @param ErosionContext - Context containing heightmap and working data.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param Progress - Optional progress, updated by both passes.
+	 * @return False if the simulation was cancelled or failed.
+	 */
+	static bool ErosionMultiresolution(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FIntPoint& GridSize, FErosionProgress* Progress);
+
+	/**
+	 * Halves the resolution of a grid of heights, averaging every 2x2 square of cells.
+	 * @param Heights - Heights to downsample.
+	 * @param Size - Width and height of the grid of heights.
+	 * @param OutHeights - Downsampled heights.
+	 * @return Width and height of the downsampled grid.
+	 */
+	static FIntPoint DownsampleHeights(const TArray<float>& Heights, const FIntPoint& Size, TArray<float>& OutHeights);
+
+	/**
+	 * Doubles the resolution of a grid of heights by bilinear interpolation, the inverse of "DownsampleHeights".
+	 * @param Heights - Heights to upsample.
+	 * @param Size - Width and height of the grid of heights.
+	 * @param OutSize - Width and height of the upsampled grid, twice "Size" or one less.
+	 * @param OutHeights - Upsampled heights.
+	 */
+	static void UpsampleHeights(const TArray<float>& Heights, const FIntPoint& Size, const FIntPoint& OutSize, TArray<float>& OutHeights);
+
+	/**
+	 * Fills the apron of a padded window with the nearest heights of the window.
+	 * @param WindowHeights - Padded heights of the window, its working area already filled.
+	 * @param Grid - Layout of the padded window.
+	 */
+	static void PadErosionWindow(TArray<float>& WindowHeights, const FErosionGrid& Grid);
+
+	/**
+	 * Selects the "SimulateDrops" specialization matching the erosion radius and wind options.
+	 * Radii without a specialization fall back to the generic kernel.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @return Kernel to use for the whole simulation.
+	 */
+	static FSimulateDropsFunction GetSimulateDropsFunction(const FErosionSettings& ErosionSettings);
+
+	/**
+	 * Looks up the kernel for a radius among the ones instantiated for the given wind options.
+	 * @param Radius - Erosion radius, the generic kernel is returned if it is not specialized.
+	 * @param Radii - Radius of each specialized kernel, 0 standing for the generic one.
+	 * @return Kernel to run for the radius.
+	 */
+	template<bool bWindBias, bool bRandomWind, int32... Radii>
+	static FSimulateDropsFunction GetSimulateDropsFunction(const int32 Radius, TIntegerSequence<int32, Radii...>);
+
+	/**
+	 * Splits the grid into tiles for a parallel round and distributes the round's drops among them.
+	 * @param Tiles - Output array of tiles (row-major, "TileCount.X" x "TileCount.Y").
+	 * @param TileSize - Side length of each tile.
+	 * @param TileCount - Number of tiles along each axis.
+	 * @param Shift - Offset applied to the tile grid for this round.
+	 * @param Margin - Distance a drop may travel outside its own tile.
+	 * @param RoundFirstDrop - Global index of the first drop of the round.
+	 * @param RoundDrops - Number of drops to distribute.
+	 * @param GridSize - Width and height of the grid of heights.
+	 */
+	static void BuildErosionTiles(TArray<FErosionTile>& Tiles, const int32 TileSize, const FIntPoint& TileCount, const FIntPoint& Shift, const int32 Margin, const int64 RoundFirstDrop, const int64 RoundDrops, const FIntPoint& GridSize);
+
+	/**
+	 * Spawns and simulates a contiguous range of drops, one at a time or in SIMD batches.
+	 * Instantiated for the common radii and wind modes, see "GetSimulateDropsFunction".
+	 * @param GridHeights - Padded heightmap modified by the drops.
+	 * @param Workspace - Temporary data owned by the calling thread.
+	 * @param Brush - Precomputed brush for the erosion radius.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param Grid - Layout of the padded heightmap.
+	 * @param SpawnDistribution - Importance distribution covering the spawn bounds, null to spawn the drops uniformly.
+	 * @param SpawnBounds - Region where the drops are spawned.
+	 * @param DropBounds - Region the drops are allowed to move in.
+	 * @param FirstDrop - Global index of the first drop, used to key the drops' random streams.
+	 * @param NumDrops - Number of drops to simulate.
+	 */
+	template<int32 Radius, bool bWindBias, bool bRandomWind>
+	static void SimulateDrops(TArray<float>& GridHeights, FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FErosionSettings& ErosionSettings, const FErosionGrid& Grid, const FErosionSpawnDistribution* SpawnDistribution, const FIntRect& SpawnBounds, const FIntRect& DropBounds, const int64 FirstDrop, const int64 NumDrops);
+
+	/**
+	 * Spawns a drop with the random stream of its global index, in the region picked by the spawn mode.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param Drop - The drop to initialize.
+	 * @param Workspace - Workspace holding the stratified spawn cells.
+	 * @param SpawnDistribution - Importance distribution covering the spawn bounds, null to spawn the drop uniformly.
+	 * @param SpawnBounds - Region where the drops are spawned.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param DropIndex - Global index of the drop.
+	 * @return Reference to the initialized drop.
+	 */
+	template<bool bWindBias, bool bRandomWind>
+	static FDrop& SpawnDrop(const FErosionSettings& ErosionSettings, FDrop& Drop, const FErosionWorkspace& Workspace, const FErosionSpawnDistribution* SpawnDistribution, const FIntRect& SpawnBounds, const FIntPoint& GridSize, const int64 DropIndex);
+
+	/**
+	 * Builds the importance spawn distribution of the heights, favouring steep cells collecting a lot of flow.
+	 * @param Distribution - Distribution to (re)build.
+	 * @param Heights - Heights of the grid, row by row.
+	 * @param GridSize - Width and height of the grid of heights.
+	 */
+	static void BuildSpawnDistribution(FErosionSpawnDistribution& Distribution, const TArray<float>& Heights, const FIntPoint& GridSize);
+
+	/**
+	 * Picks the cell a drop is spawned in from the importance distribution.
+	 * @param Distribution - Distribution covering the spawn bounds.
+	 * @param SpawnBounds - Region where the drops are spawned.
+	 * @param RandomStream - Random stream of the drop.
+	 * @param OutWater - Water the drop starts with, compensating for the probability of the cell.
+	 * @return Region of the picked cell.
+	 */
+	static FIntRect SampleSpawnDistribution(const FErosionSpawnDistribution& Distribution, const FIntRect& SpawnBounds, FErosionRandomStream& RandomStream, float& OutWater);
+
+	/**
+	 * Applies erosion effects for a batch of drops advanced in lockstep with SIMD math.
+	 * Brush writes and deposits are applied lane by lane.
+	 * "Radius" is the compile-time erosion radius, negative for the generic version.
+	 * @param GridHeights - Padded heightmap modified by the drops.
+	 * @param Workspace - Temporary data owned by the calling thread.
+	 * @param Brush - Precomputed brush for the erosion radius.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
+	 * @param Batch - The drops being simulated.
+	 * @param Grid - Layout of the padded heightmap.
+	 * @param DropBounds - Region the drops are allowed to move in.
+	 */
+	template<int32 Radius>
+	static void ApplyErosionBatch(TArray<float>& GridHeights, FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FErosionSettings& ErosionSettings, FDropBatch& Batch, const FErosionGrid& Grid, const FIntRect& DropBounds);
+
+	/**
+	 * Applies erosion effects for a single water drop simulation.
+	 * "Radius" is the compile-time erosion radius, negative for the generic version.
+	 * @param GridHeights - Padded heightmap modified by the drop.
+	 * @param Workspace - Temporary data owned by the calling thread.
+	 * @param Brush - Precomputed brush for the erosion radius.
+	 * @param ErosionSettings - Settings controlling erosion behavior.
 	 * @param Drop - The water drop being simulated.
-	 * @param GridSize - Size of the square grid of heights.
+	 * @param Grid - Layout of the padded heightmap.
+	 * @param DropBounds - Region the drop is allowed to move in.
+	 */
+	template<int32 Radius>
+	static void ApplyErosion(TArray<float>& GridHeights, FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FErosionSettings& ErosionSettings, FDrop& Drop, const FErosionGrid& Grid, const FIntRect& DropBounds);
+
+	/**
+	 * Splits the spawn bounds into the cells of the stratified spawn and sorts them along a Z-order curve.
+	 * Nothing is done if the workspace already holds the cells of the same bounds.
+	 * @param Workspace - Workspace to store the cells in.
+	 * @param SpawnBounds - Region where the drops are spawned.
 	 */
-	static void ApplyErosion(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, FDrop& Drop, const int32 GridSize);
+	static void BuildSpawnStrata(FErosionWorkspace& Workspace, const FIntRect& SpawnBounds);
+
+	/**
+	 * Returns the region a drop is spawned in: the whole spawn bounds, or one of their cells with the stratified spawn.
+	 * Consecutive drops take consecutive cells, so they start next to each other and every cell receives a drop per pass.
+	 * @param Workspace - Workspace holding the cells of the spawn bounds (see "BuildSpawnStrata").
+	 * @param SpawnBounds - Region where the drops are spawned.
+	 * @param bStratifiedSpawn - Whether the drops are spawned stratified.
+	 * @param DropIndex - Global index of the drop.
+	 * @return Region where the drop is spawned.
+	 */
+	static FIntRect GetDropSpawnBounds(const FErosionWorkspace& Workspace, const FIntRect& SpawnBounds, const bool bStratifiedSpawn, const int64 DropIndex);
 
 	/**
 	 * Initializes a water drop with starting position, direction, and properties.
+	 * The wind options are compile-time parameters, so their branches are folded away.
 	 * @param ErosionSettings - Settings containing initialization parameters.
 	 * @param Drop - The drop to initialize.
-	 * @param GridSize - Size of the square grid of heights.
+	 * @param SpawnBounds - Region where the drop is spawned.
+	 * @param GridSize - Width and height of the grid of heights.
+	 * @param RandomStream - Random stream of the drop, used to randomize position and direction.
 	 * @return Reference to the initialized drop.
 	 */
-	static FDrop& InitDrop(const FErosionSettings& ErosionSettings, FDrop& Drop, const int32 GridSize);
+	template<bool bWindBias, bool bRandomWind>
+	static FDrop& InitDrop(const FErosionSettings& ErosionSettings, FDrop& Drop, const FIntRect& SpawnBounds, const FIntPoint& GridSize, FErosionRandomStream& RandomStream);
+
+	/**
+	 * Builds the brush offsets and normalized weights for the given erosion radius.
+	 * @param Brush - Brush to (re)build.
+	 * @param Radius - Erosion radius of the brush.
+	 * @param Stride - Row pitch of the padded grid the brush is applied to.
+	 */
+	static void BuildErosionBrush(FErosionBrush& Brush, const int32 Radius, const int32 Stride);
 
 	/**
 	 * Initializes weight values for cells within the erosion radius of the drop.
-	 * @param ErosionContext - Context to store calculated weights.
-	 * @param ErosionSettings - Settings containing erosion radius.
+	 * With a compile-time "Radius" the brush size is a constant and the table walk can be fully unrolled.
+	 * @param Workspace - Workspace to store calculated weights.
+	 * @param Brush - Precomputed brush for the erosion radius.
 	 * @param DropPosition - Current position of the drop.
-	 * @param GridSize - Size of the square grid of heights.
+	 * @param Grid - Layout of the padded heightmap.
 	 */
-	static void InitWeights(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FVector2D& DropPosition, const int32 GridSize);
+	template<int32 Radius>
+	static void InitWeights(FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FVector2f& DropPosition, const FErosionGrid& Grid);
 
 	/**
 	 * Computes the gradient vector from four corner height values.
@@ -157,7 +853,7 @@ private:
 	 * @param P4 - Height at fourth corner.
 	 * @return Gradient vector in 2D.
 	 */
-	static FVector2D ComputeGradient(const float P1, const float P2, const float P3, const float P4);
+	static FVector2f ComputeGradient(const float P1, const float P2, const float P3, const float P4);
 
 	/**
 	 * Computes gradient using bilinear interpolation of four values.
@@ -168,17 +864,17 @@ private:
 	 * @param F4 - Fourth interpolation value.
 	 * @return Interpolated gradient vector.
 	 */
-	static FVector2D ComputeGradientByInterpolate(const FVector2D& OffsetPosition, const float F1, const float F2, const float F3, const float F4);
+	static FVector2f ComputeGradientByInterpolate(const FVector2f& OffsetPosition, const float F1, const float F2, const float F3, const float F4);
 
 	/**
 	 * Retrieves and sets the height values for the four corners of a grid cell.
-	 * @param ErosionContext - Context containing height data.
+	 * @param GridHeights - Padded heightmap to read from.
 	 * @param InCornersHeights - Structure to populate with corner heights.
 	 * @param TruncatedPosition - Integer grid position.
-	 * @param GridSize - Size of the square grid of heights.
+	 * @param Grid - Layout of the padded heightmap.
 	 * @return Reference to the populated corner heights structure.
 	 */
-	static FCornersHeights& SetCornersHeights(const FErosionContext& ErosionContext, FCornersHeights& InCornersHeights, const FVector2D& TruncatedPosition, const int32 GridSize);
+	static FCornersHeights& SetCornersHeights(const TArray<float>& GridHeights, FCornersHeights& InCornersHeights, const FIntPoint& TruncatedPosition, const FErosionGrid& Grid);
 
 	/**
 	 * Performs bilinear interpolation using corner heights and offset position.
@@ -186,65 +882,42 @@ private:
 	 * @param CornersHeights - Heights at the four corners of the cell.
 	 * @return Interpolated height value at the given position.
 	 */
-	static float GetBilinearInterpolation(const FVector2D& OffsetPosition, const FCornersHeights& CornersHeights);
+	static float GetBilinearInterpolation(const FVector2f& OffsetPosition, const FCornersHeights& CornersHeights);
 
 	/**
-	 * Identifies and stores all grid points within the erosion radius of the drop.
-	 * @param ErosionContext - Context to store affected points.
-	 * @param ErosionSettings - Settings containing erosion radius.
-	 * @param DropPosition - Current position of the drop.
-	 * @param GridSize - Size of the square grid of heights.
+	 * Pre-allocates the workspace for the points and weights of the given brush, and for the stratified spawn cells.
+	 * @param Workspace - Workspace to reserve.
+	 * @param Brush - Brush the workspace will be used with.
+	 * @param MaxSpawnSize - Largest spawn bounds the workspace will be used with.
 	 */
-	static void SetInRadiusPoints(FErosionContext& ErosionContext, const FErosionSettings& ErosionSettings, const FVector2D& DropPosition, const int32 GridSize);
-
-	/**
-	 * Calculates the relative weight of a point based on its distance from the drop.
-	 * @param ErosionSettings - Settings containing erosion radius.
-	 * @param DropPosition - Current position of the drop.
-	 * @param PointPosition - Position of the point to evaluate.
-	 * @return Weight value indicating influence strength.
-	 */
-	static float GetRelativeWeightOnPoint(const FErosionSettings& ErosionSettings, const FVector2D& DropPosition, const FVector2D& PointPosition);
-
-	/**
-	 * Calculates erosion amounts for all affected points based on weights.
-	 * @param ErosionContext - Context containing points and weights.
-	 * @param ErosionFactor - Multiplier for erosion strength.
-	 * @return Array of erosion amounts for each affected point.
-	 */
-	static TArray<float> GetErosionOnPoints(const FErosionContext& ErosionContext, const float ErosionFactor);
+	static void ReserveWorkspace(FErosionWorkspace& Workspace, const FErosionBrush& Brush, const FIntPoint& MaxSpawnSize);
 
 	/**
 	 * Distributes sediment deposit across nearby grid points using interpolation.
-	 * @param ErosionContext - Context to modify with deposited sediment.
+	 * @param GridHeights - Padded heightmap to modify with deposited sediment.
 	 * @param IntegerPosition - Integer grid position.
 	 * @param OffsetPosition - Fractional position within the cell.
 	 * @param Deposit - Amount of sediment to deposit.
-	 * @param GridSize - Size of the square grid of heights.
+	 * @param Grid - Layout of the padded heightmap.
 	 */
-	static void ComputeDepositOnPoints(FErosionContext& ErosionContext, const FVector2D& IntegerPosition, const FVector2D& OffsetPosition, const float Deposit, const int32 GridSize);
+	static void ComputeDepositOnPoints(TArray<float>& GridHeights, const FIntPoint& IntegerPosition, const FVector2f& OffsetPosition, const float Deposit, const FErosionGrid& Grid);
 
 	/**
-	 * Checks if a position is outside the valid grid boundaries.
+	 * Checks if a position is outside the given region of the grid.
 	 * @param DropPosition - Position to check.
-	 * @param GridSize - Size of the square grid of heights.
+	 * @param Bounds - Region of valid cells.
 	 * @return True if position is out of bounds, false otherwise.
 	 */
-	static bool IsOutOfBound(const FVector2D& DropPosition, const int32 GridSize);
-
-	/**
-	 * Determines which boundary (if any) a position exceeds.
-	 * @param IntegerPosition - Integer grid position to check.
-	 * @param GridSize - Size of the square grid of heights.
-	 * @return Enumeration indicating which boundaries are exceeded.
-	 */
-	static EOutOfBoundResult GetOutOfBoundAsResult(const FVector2D& IntegerPosition, const int32 GridSize);
+	static bool IsOutOfBound(const FVector2f& DropPosition, const FIntRect& Bounds);
 
 	/**
 	 * Calculates wind direction vector from erosion settings.
+	 * "bWindBias" and "bRandomWind" must match the erosion settings.
 	 * @param ErosionSettings - Settings containing wind parameters.
+	 * @param RandomStream - Random stream of the drop, used to randomize angle and strength.
 	 * @return 2D direction vector representing wind direction.
 	 */
-	static FVector2D GetWindDirection(const FErosionSettings& ErosionSettings);
+	template<bool bWindBias, bool bRandomWind>
+	static FVector2f GetWindDirection(const FErosionSettings& ErosionSettings, FErosionRandomStream& RandomStream);
 
 };
\ No newline at end of file
@@ -13,6 +13,7 @@ struct FHeightMapGenerationSettings;
 struct FExternalHeightMapSettings;
 struct FLandscapeGenerationSettings;
 struct FErosionSettings;
+struct FErosionProgress;
 class FDropByDropSettings;
 
 class ALandscape;
@@ -35,6 +36,10 @@ struct FErosionTemplateRow : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ErosionTemplateRow")
 	int64 ErosionCyclesField;
 
+	// Seed of the droplets' random streams, used to reproduce an erosion.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ErosionTemplateRow")
+	int32 ErosionSeedField;
+
 	// How much the water droplet maintains its direction of flow.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "ErosionTemplateRow")
 	float InertiaField;
@@ -88,6 +93,33 @@ enum class ERawFormat
 	RGBA16F     // 16-bit floating point per channel (HDR).
 };
 
+/**
+ * Perlin noise field of a procedural heightmap, derived once from its generation settings.
+ * Any tile of the heightmap can be sampled from it on demand; the normalization bounds are part
+ * of the field, so tiles generated separately line up without a global pass over the heights.
+ */
+struct FHeightMapNoiseField
+{
+	// Size of the whole heightmap, in cells.
+	FIntPoint Size = FIntPoint::ZeroValue;
+
+	// Longest side of the heightmap, noise is sampled at the same scale on both axes.
+	float MapSize = 1.f;
+
+	// Offset, scale and weight of each octave.
+	TArray<FVector2D> Offsets;
+	TArray<float> Scales;
+	TArray<float> Weights;
+
+	// Noise range mapped to [0, MaxHeightDifference], values outside of it are clamped.
+	float MinValue = 0.f;
+	float MaxValue = 0.f;
+	float MaxHeightDifference = 1.f;
+
+	// Whether the noise is sampled by "VectorPerlinNoise2D".
+	bool bVectorizedNoise = false;
+};
+
 #pragma endregion
 
 /**
@@ -109,10 +141,51 @@ public:
 	 */
 	static bool GenerateErosion(TObjectPtr<ALandscape> ActiveLandscape, FErosionSettings& ErosionSettings);
 
+	/**
+	 * Applies erosion simulation to an existing landscape without blocking the editor.
+	 * The simulation runs on a background task over a copy of the heightmap and settings;
+	 * only the creation of the eroded landscape goes back to the game thread.
+	 * @param ActiveLandscape - The landscape to apply erosion to.
+	 * @param ErosionSettings - Configuration settings for the erosion algorithm, copied by the task.
+	 * @param Progress - Progress of the simulation, also used to cancel it.
+	 * @param OnCompleted - Called on the game thread when the task ends, with true if a new landscape was created.
+	 * @return True if the erosion task was started, false otherwise.
+	 */
+	static bool GenerateErosionAsync(TObjectPtr<ALandscape> ActiveLandscape, const FErosionSettings& ErosionSettings, const TSharedRef<FErosionProgress>& Progress, TFunction<void(bool)> OnCompleted);
+
+	/**
+	 * Downsamples the heightmap of a landscape for the erosion preview, averaging the cells covered by every preview cell.
+	 * @param ActiveLandscape - The landscape to preview the erosion of.
+	 * @param OutHeights - Output: normalized heights of the preview, at most "EROSION_PREVIEW_SIZE" cells per side.
+	 * @param OutSize - Output: width and height of the preview.
+	 * @return True if the landscape holds a heightmap to preview, false otherwise.
+	 */
+	static bool CreateErosionPreviewHeights(const ALandscape* ActiveLandscape, TArray<float>& OutHeights, FIntPoint& OutSize);
+
+	/**
+	 * Erodes a copy of the preview heights on a background task with a small drop budget, then shades the result.
+	 * The preview shows the character of the settings at its own scale, not the final landscape.
+	 * @param PreviewHeights - Normalized heights of the preview, see "CreateErosionPreviewHeights".
+	 * @param PreviewSize - Width and height of the preview.
+	 * @param ErosionSettings - Configuration settings for the erosion algorithm, copied by the task.
+	 * @param Progress - Progress of the preview, used to cancel it when a newer one is requested.
+	 * @param OnCompleted - Called on the game thread with the shaded pixels, unless the preview was cancelled.
+	 */
+	static void GenerateErosionPreviewAsync(const TArray<float>& PreviewHeights, const FIntPoint& PreviewSize, const FErosionSettings& ErosionSettings, const TSharedRef<FErosionProgress>& Progress, TFunction<void(TArray<FColor>&&)> OnCompleted);
+
+	/**
+	 * Creates a transient texture displaying the shaded pixels of an erosion preview.
+	 * @param Pixels - Pixels returned by "GenerateErosionPreviewAsync".
+	 * @param Size - Width and height of the preview.
+	 * @return Generated texture object.
+	 */
+	static UTexture2D* CreateErosionPreviewTexture(const TArray<FColor>& Pixels, const FIntPoint& Size);
+
 	/**
 	 * Saves a new erosion template with specified parameters to persistent storage.
 	 * @param TemplateName - Name identifier for the template.
 	 * @param ErosionCyclesValue - Number of simulation cycles.
+	 * @param ErosionSeedValue - Seed of the droplets' random streams.
 	 * @param InertiaValue - Flow direction persistence.
 	 * @param CapacityValue - Sediment carrying capacity.
 	 * @param MinSlopeValue - Minimum slope for erosion.
@@ -124,7 +197,7 @@ public:
 	 * @param ErosionRadiusValue - Erosion effect radius.
 	 * @return True if save was successful, false otherwise.
 	 */
-	static bool SaveErosionTemplate(const FString& TemplateName, const int32 ErosionCyclesValue, const float InertiaValue, const int32 CapacityValue, const float MinSlopeValue, const float DepositionSpeedValue, const float ErosionSpeedValue, const int32 GravityValue, const float EvaporationValue, const int32 MaxPathValue, const int32 ErosionRadiusValue);
+	static bool SaveErosionTemplate(const FString& TemplateName, const int32 ErosionCyclesValue, const int32 ErosionSeedValue, const float InertiaValue, const int32 CapacityValue, const float MinSlopeValue, const float DepositionSpeedValue, const float ErosionSpeedValue, const int32 GravityValue, const float EvaporationValue, const int32 MaxPathValue, const int32 ErosionRadiusValue);
 
 	/**
 	 * Saves an entire data table of erosion templates.
@@ -166,10 +239,78 @@ public:
 
 	/**
 	 * Opens a file dialog for the user to select an external heightmap file.
+	 * PNG files are saved as the preview texture; RAW files are only checked, no preview asset is saved for them.
 	 * @param ExternalSettings - Settings object to populate with file information.
 	 * @return True if a file was successfully selected, false if the dialog was canceled.
 	 */
 	static bool OpenHeightmapFileDialog(TSharedPtr<FExternalHeightMapSettings> ExternalSettings);
+
+	/**
+	 * Checks whether a file is a RAW heightmap, from its extension.
+	 * @param FilePath - Path of the file.
+	 * @return True for ".r16" and ".raw" files.
+	 */
+	static bool IsRawHeightmapFile(const FString& FilePath);
+
+	/**
+	 * Evaluates 2D Perlin gradient noise at four locations at once, in single precision.
+	 * Same permutation, gradients and fade curve as "FMath::PerlinNoise2D", so it gives the same noise
+	 * up to single precision rounding, in the (-1, 1) range.
+	 * @param LocationX - X coordinates of the four locations.
+	 * @param LocationY - Y coordinates of the four locations.
+	 * @return Noise at each location.
+	 */
+	static VectorRegister4Float VectorPerlinNoise2D(const VectorRegister4Float& LocationX, const VectorRegister4Float& LocationY);
+
+	/**
+	 * Derives the noise field of a heightmap from its generation settings.
+	 * @param HeightMapSettings - Perlin noise parameters of the heightmap.
+	 * @param Size - Size of the heightmap, in cells; the terrain keeps its shape at any resolution.
+	 * @param OutField - Noise field, ready to be sampled one tile at a time.
+	 * @param bEstimateBounds - If true, estimates the normalization bounds from a coarse grid of samples.
+	 */
+	static void CreateHeightMapNoiseField(const FHeightMapGenerationSettings& HeightMapSettings, const FIntPoint& Size, FHeightMapNoiseField& OutField, const bool bEstimateBounds = true);
+
+	/**
+	 * Generates a single tile of a heightmap, normalized with the bounds of its noise field.
+	 * @param Field - Noise field of the heightmap.
+	 * @param Tile - Cells of the tile, max excluded.
+	 * @param OutHeights - Heights of the tile, row by row.
+	 */
+	static void GenerateHeightMapTile(const FHeightMapNoiseField& Field, const FIntRect& Tile, TArray<float>& OutHeights);
+
+	/**
+	 * Generates a heightmap band by band straight into a 16-bit RAW file, with bounded memory.
+	 * @param HeightMapSettings - Perlin noise parameters of the heightmap.
+	 * @param Size - Size of the heightmap, in cells, not limited by the landscape import resolution.
+	 * @param FilePath - Path of the ".r16" file to write, next to which the size of a non-square heightmap is saved.
+	 * @return True if the whole heightmap was written.
+	 */
+	static bool GenerateHeightMapToFile(const FHeightMapGenerationSettings& HeightMapSettings, const FIntPoint& Size, const FString& FilePath);
+
+	/**
+	 * Opens a native dialog to choose where to save a RAW heightmap.
+	 * @param OutFilePath - Selected file path.
+	 * @return True if a file was selected, false if the dialog was canceled.
+	 */
+	static bool SaveHeightmapFileDialog(FString& OutFilePath);
+
+	/**
+	 * Writes 16-bit heights as they are into a RAW file, row by row, and the size of a non-square heightmap next to it.
+	 * @param FilePath - Path of the ".r16" or ".raw" file to write.
+	 * @param Heightmap - Heights to write.
+	 * @param Size - Width and height of the heightmap.
+	 * @return True if the whole heightmap was written.
+	 */
+	static bool SaveRawHeightmap(const FString& FilePath, TConstArrayView<uint16> Heightmap, const FIntPoint& Size);
+
+	/**
+	 * Exports the stored heightmap of a landscape, eroded or not, into a RAW file.
+	 * @param ActiveLandscape - Landscape whose heightmap is exported.
+	 * @param FilePath - Path of the ".r16" or ".raw" file to write.
+	 * @return True if the heightmap was exported.
+	 */
+	static bool ExportLandscapeHeightmap(const ALandscape* ActiveLandscape, const FString& FilePath);
 #pragma endregion
 
 #pragma region Landscape
@@ -225,6 +366,42 @@ public:
 #pragma endregion
 
 private:
+#pragma region Erosion (Private)
+	/**
+	 * Creates a new landscape from the eroded heights of an existing one, copying all its settings.
+	 * @param ActiveLandscape - The landscape the erosion was applied to.
+	 * @param ErodedHeights - Normalized heights returned by the erosion simulation, moved into the landscape info.
+	 * @return True if the eroded landscape was created, false otherwise.
+	 */
+	static bool CreateErodedLandscape(ALandscape* ActiveLandscape, TArray<float>&& ErodedHeights);
+
+	/**
+	 * Writes the eroded heights into the landscape they were taken from, proxies included.
+	 * Only the landscape components whose heights changed are updated.
+	 * @param ActiveLandscape - The landscape the erosion was applied to.
+	 * @param ErodedHeights - Normalized heights returned by the erosion simulation, moved into the landscape info.
+	 * @return True if the heights were applied, false otherwise.
+	 */
+	static bool ApplyErodedHeightsInPlace(ALandscape* ActiveLandscape, TArray<float>&& ErodedHeights);
+
+	/**
+	 * Applies the eroded heights as requested by the erosion settings, in place or on a new landscape.
+	 * @param ActiveLandscape - The landscape the erosion was applied to.
+	 * @param ErodedHeights - Normalized heights returned by the erosion simulation, moved into the landscape info.
+	 * @param bApplyInPlace - Whether to write the heights into "ActiveLandscape" instead of spawning a new one.
+	 * @return True if the heights were applied, false otherwise.
+	 */
+	static bool ApplyErodedHeights(ALandscape* ActiveLandscape, TArray<float>&& ErodedHeights, const bool bApplyInPlace);
+
+	/**
+	 * Shades normalized heights as lit relief, lighting them from the north-west.
+	 * @param Heights - Normalized heights to shade.
+	 * @param Size - Width and height of the grid of heights.
+	 * @param OutPixels - Output: one opaque pixel per height.
+	 */
+	static void ShadeErosionPreview(const TArray<float>& Heights, const FIntPoint& Size, TArray<FColor>& OutPixels);
+#pragma endregion
+
 #pragma region Heightmap (Private)
 	/**
 	 * Generates a heightmap as an array of normalized float values.
@@ -233,6 +410,16 @@ private:
 	 */
 	static TArray<float> CreateHeightMapArray(const FHeightMapGenerationSettings& HeightMapSettings);
 
+	/**
+	 * Samples the raw (not normalized) noise of a run of cells of a heightmap row.
+	 * @param Field - Noise field of the heightmap.
+	 * @param Row - Row of the cells.
+	 * @param StartColumn - Column of the first cell.
+	 * @param NumCells - Number of cells to sample.
+	 * @param OutNoise - Noise of each cell.
+	 */
+	static void SampleHeightMapRow(const FHeightMapNoiseField& Field, const int32 Row, const int32 StartColumn, const int32 NumCells, float* OutNoise);
+
 	/**
 	 * Creates a "Texture2D" asset from heightmap data for visualization and export.
 	 * @param HeightMapData - Array of normalized height values.
@@ -247,9 +434,49 @@ private:
 	 * @param FilePath - Full path to the heightmap file.
 	 * @param OutHeightmap - Output array of 16-bit height values.
 	 * @param OutNormalizedHeightmap - Output array of normalized height values.
+	 * @param OutSize - Output: width and height of the loaded heightmap.
 	 * @param Settings - Settings to populate with file metadata.
 	 */
-	static void LoadHeightmapFromFileSystem(const FString& FilePath, TArray<uint16>& OutHeightmap, TArray<float>& OutNormalizedHeightmap, FExternalHeightMapSettings& Settings);
+	static void LoadHeightmapFromFileSystem(const FString& FilePath, TArray<uint16>& OutHeightmap, TArray<float>& OutNormalizedHeightmap, FIntPoint& OutSize, FExternalHeightMapSettings& Settings);
+
+	/**
+	 * Finds the size of a 16-bit RAW heightmap without reading it: from the size file saved next to it if any,
+	 * otherwise from the size of the file, assuming a square heightmap.
+	 * @param FilePath - Path of the ".r16" or ".raw" file.
+	 * @param OutSize - Size of the heightmap.
+	 * @return True if the file holds a heightmap of that size.
+	 */
+	static bool GetRawHeightmapSize(const FString& FilePath, FIntPoint& OutSize);
+
+	/**
+	 * Saves the size of a non-square RAW heightmap next to it, as RAW files carry no header.
+	 * Square heightmaps need none, a stale size file is deleted.
+	 * @param FilePath - Path of the ".r16" or ".raw" file.
+	 * @param Size - Width and height of the heightmap.
+	 * @return False if the size file could not be written.
+	 */
+	static bool SaveRawHeightmapSize(const FString& FilePath, const FIntPoint& Size);
+
+	/**
+	 * Loads a 16-bit RAW heightmap by mapping the file in memory, without going through a texture.
+	 * Its size comes from "GetRawHeightmapSize".
+	 * The mapped heights are copied once into "OutHeightmap".
+	 * @param FilePath - Path of the ".r16" or ".raw" file.
+	 * @param OutHeightmap - Copy of the heights of the file, as they are.
+	 * @param OutSize - Size of the heightmap, inferred from the file size.
+	 * @return True if the size of the heightmap is known and the file was read.
+	 */
+	static bool LoadRawHeightmap(const FString& FilePath, TArray<uint16>& OutHeightmap, FIntPoint& OutSize);
+
+	/**
+	 * Decodes a PNG heightmap at its full bit depth, without going through a texture.
+	 * @param FilePath - Path of the ".png" file.
+	 * @param OutHeightmap - 16-bit heights of the image (red channel of color images).
+	 * @param OutNormalizedHeightmap - Heights stretched to the [0, 1] range.
+	 * @param OutSize - Size of the heightmap.
+	 * @return True if the file was decoded.
+	 */
+	static bool LoadPngHeightmap(const FString& FilePath, TArray<uint16>& OutHeightmap, TArray<float>& OutNormalizedHeightmap, FIntPoint& OutSize);
 
 	/**
 	 * Debugging utility to compare a generated heightmap with a RAW file on disk.
@@ -261,16 +488,26 @@ private:
 	static void CompareHeightmaps(const FString& RawFilePath, const TArray<uint16>& GeneratedHeightmap, int32 Width, int32 Height);
 
 	/**
-	 * Standardizes a heightmap to the engine's standard resolution (505x505).
+	 * Standardizes a heightmap to the closest resolution a landscape can be imported at.
 	 *
-	 * This function handles heightmaps of any square resolution and resamples them
-	 * to the standardized 505x505 format required by the landscape system.
+	 * Heightmaps already at a valid landscape resolution (e.g. 505, 1009, 2017, 4033, 8129,
+	 * square or not) are returned untouched; any other resolution is resampled to the one
+	 * chosen by "FLandscapeImportHelper::ChooseBestComponentSizeForImport".
 	 * Uses bilinear interpolation to preserve terrain detail during scaling.
 	 *
-	 * @param SourceHeightmap - The input heightmap as uint16 array (any square resolution).
-	 * @return Standardized heightmap at 505x505 resolution, or empty array on error.
+	 * @param SourceHeightmap - The input heightmap as uint16 array, moved from when no resampling is needed.
+	 * @param SourceSize - Width and height of the input heightmap.
+	 * @param OutSize - Output: width and height of the standardized heightmap.
+	 * @return Standardized heightmap, or empty array on error.
+	 */
+	static TArray<uint16> StandardizeHeightmapResolution(TArray<uint16>&& SourceHeightmap, const FIntPoint& SourceSize, FIntPoint& OutSize);
+
+	/**
+	 * Gets the landscape resolution closest to the given heightmap resolution.
+	 * @param HeightmapSize - Width and height of the heightmap.
+	 * @return Width and height, in vertices, of the landscape the heightmap would be imported into.
 	 */
-	static TArray<uint16> StandardizeHeightmapResolution(const TArray<uint16>& SourceHeightmap);
+	static FIntPoint GetLandscapeResolution(const FIntPoint& HeightmapSize);
 #pragma endregion
 
 #pragma region Utilities (Private)
@@ -278,10 +515,10 @@ private:
 	 * Calculates the world transform for a new landscape based on settings and heightmap size.
 	 * @param ExternalSettings - Imported from file system heightmap settings.
 	 * @param LandscapeSettings - Landscape generation settings.
-	 * @param HeightmapSize - Size of the heightmap.
+	 * @param HeightmapSize - Width and height of the heightmap, the longest side spans the requested kilometers.
 	 * @return Calculated transform for landscape placement.
 	 */
-	static FTransform GetNewTransform(const FExternalHeightMapSettings& ExternalSettings, const FLandscapeGenerationSettings& LandscapeSettings, int32 HeightmapSize);
+	static FTransform GetNewTransform(const FExternalHeightMapSettings& ExternalSettings, const FLandscapeGenerationSettings& LandscapeSettings, const FIntPoint& HeightmapSize);
 
 	/**
 	 * Saves a texture as a persistent asset in the Unreal content browser.
@@ -323,20 +560,22 @@ private:
 	/**
 	 * Core function to spawn a landscape actor with given heightmap data.
 	 * @param LandscapeTransform - World transform (location, rotation, scale) for the landscape.
-	 * @param Heightmap - 16-bit heightmap data.
+	 * @param Heightmap - 16-bit heightmap data, moved into the landscape import.
+	 * @param HeightmapSize - Width and height of the heightmap, must be a valid landscape resolution.
 	 * @return Pointer to the created landscape.
 	 */
-	static TObjectPtr<ALandscape> GenerateLandscape(const FTransform& LandscapeTransform, TArray<uint16>& Heightmap);
+	static TObjectPtr<ALandscape> GenerateLandscape(const FTransform& LandscapeTransform, TArray<uint16>&& Heightmap, const FIntPoint& HeightmapSize);
 
 	/**
 	 * Initializes landscape data structures and validates settings before creation.
-	 * @param HeightData - Heightmap data array.
+	 * @param HeightData - Heightmap data array, moved into the landscape import.
+	 * @param HeightmapSize - Width and height of the heightmap, must be a valid landscape resolution.
 	 * @param HeightmapSettings - Heightmap generation settings.
 	 * @param ExternalSettings - Imported from file system file settings.
 	 * @param LandscapeSettings - Landscape creation settings.
 	 * @return True if initialization was successful, false otherwise.
 	 */
-	static bool InitLandscape(TArray<uint16>& HeightData, FHeightMapGenerationSettings& HeightmapSettings, FExternalHeightMapSettings& ExternalSettings, FLandscapeGenerationSettings& LandscapeSettings);
+	static bool InitLandscape(TArray<uint16>&& HeightData, const FIntPoint& HeightmapSize, FHeightMapGenerationSettings& HeightmapSettings, FExternalHeightMapSettings& ExternalSettings, FLandscapeGenerationSettings& LandscapeSettings);
 
 	/**
 	 * Calculates the starting position for wind preview visualization on the landscape.
@@ -349,14 +588,14 @@ private:
 	/**
 	 * Calculates and validates landscape size parameters based on desired dimensions.
 	 * Unreal landscapes have specific size requirements (power-of-2 based).
-	 * @param SubSectionSizeQuads - Output: quads per subsection.
-	 * @param NumSubsections - Output: number of subsections.
+	 * @param SubSectionSizeQuads - Input/Output: quads per subsection, the starting point if no layout matches the size exactly.
+	 * @param NumSubsections - Input/Output: number of subsections, the starting point if no layout matches the size exactly.
 	 * @param MaxX - Output: maximum X dimension.
 	 * @param MaxY - Output: maximum Y dimension.
-	 * @param Size - Desired size (default 505).
+	 * @param Size - Desired width and height.
 	 * @return True if parameters are valid.
 	 */
-	static bool SetLandscapeSizeParam(int32& SubSectionSizeQuads, int32& NumSubsections, int32& MaxX, int32& MaxY, const int32 Size = 505);
+	static bool SetLandscapeSizeParam(int32& SubSectionSizeQuads, int32& NumSubsections, int32& MaxX, int32& MaxY, const FIntPoint& Size);
 #pragma endregion
 
 };
\ No newline at end of file
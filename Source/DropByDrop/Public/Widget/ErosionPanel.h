@@ -10,7 +10,10 @@ struct FHeightMapGenerationSettings;
 struct FExternalHeightMapSettings;
 struct FLandscapeGenerationSettings;
 struct FErosionSettings;
+struct FErosionProgress;
 class UErosionTemplateManager;
+class FActiveTimerHandle;
+class UTexture2D;
 class ALandscape;
 
 #pragma endregion 
@@ -68,6 +71,43 @@ private: // Members.
 	/** Template manager for preset save/load/delete functionality. */
 	TObjectPtr<UErosionTemplateManager> TemplateManager;
 
+	/** Progress of the erosion running in background, null when no erosion is running. */
+	TSharedPtr<FErosionProgress> ErosionProgress;
+
+	/** Drops simulated and time taken by the last completed erosion, empty before the first one. */
+	FString LastErosionReport;
+
+	/** Drops simulated by the last completed erosion, to reproduce it without time budget or early stop. */
+	int64 LastSimulatedDrops = 0;
+
+	// Live preview data.
+	/** If true, a small copy of the heightmap is eroded in background whenever an erosion parameter changes. */
+	bool bLivePreview = false;
+
+	/** Progress of the running erosion preview, cancelled as soon as a newer one is requested. */
+	TSharedPtr<FErosionProgress> PreviewProgress;
+
+	/** Downsampled heights of "PreviewLandscape" eroded by the preview. */
+	TArray<float> PreviewHeights;
+
+	/** Width and height of "PreviewHeights". */
+	FIntPoint PreviewSize = FIntPoint::ZeroValue;
+
+	/** Landscape "PreviewHeights" were taken from, reset when its heights change. */
+	TWeakObjectPtr<ALandscape> PreviewLandscape;
+
+	/** Time of the last edit: the preview starts once the edits pause for "EROSION_PREVIEW_DELAY". */
+	double PreviewRequestTime = 0.0;
+
+	/** Timer starting the pending preview, null when no preview is pending. */
+	TSharedPtr<FActiveTimerHandle> PreviewTimer;
+
+	/** Slate brush displaying "PreviewTexture". */
+	TSharedPtr<FSlateBrush> PreviewBrush;
+
+	/** Strong reference to the last preview texture to prevent garbage collection. */
+	TStrongObjectPtr<UTexture2D> PreviewTexture;
+
 	// Wind UI data.
 	/** Array of available wind direction options for the dropdown menu. */
 	TArray<TSharedPtr<FString>> WindDirections;
@@ -104,10 +144,62 @@ private: // Methods.
 
 	/**
 	 * Handles the "Erode" button click event.
-	 * Triggers the erosion generation process on the active landscape.
+	 * Starts the erosion generation process on the active landscape in background.
 	 *
 	 * @return FReply::Handled() to indicate the event was processed.
 	 */
 	FReply OnErodeClicked();
 
+	/**
+	 * Handles the "Cancel" button click event.
+	 * Requests the running erosion to stop.
+	 *
+	 * @return FReply::Handled() to indicate the event was processed.
+	 */
+	FReply OnCancelClicked();
+
+	/**
+	 * Handles the "Reproduce" button click event.
+	 * Sets the erosion cycles to the drops simulated by the last erosion and disables its early stops,
+	 * so the next erosion repeats it whatever the time it takes.
+	 *
+	 * @return FReply::Handled() to indicate the event was processed.
+	 */
+	FReply OnReproduceClicked();
+
+	/**
+	 * Creates a button setting the erosion time budget to a preset.
+	 *
+	 * @param Seconds - Time budget set by the button.
+	 * @return The preset button.
+	 */
+	TSharedRef<SWidget> MakeTimeBudgetPresetButton(const float Seconds);
+
+	/**
+	 * Schedules an erosion preview after the current edit, if the live preview is enabled.
+	 * Edits closer than "EROSION_PREVIEW_DELAY" to each other only start one preview, after the last of them.
+	 */
+	void RequestErosionPreview();
+
+	/**
+	 * Active timer callback starting the erosion preview once the edits pause.
+	 *
+	 * @param CurrentTime - Current application time.
+	 * @param DeltaTime - Time since the last tick.
+	 * @return Stop once the preview started, continue while edits keep coming.
+	 */
+	EActiveTimerReturnType UpdateErosionPreview(double CurrentTime, float DeltaTime);
+
+	/**
+	 * Cancels the running preview and erodes the preview heights with the current settings.
+	 */
+	void StartErosionPreview();
+
+	/**
+	 * Checks whether an erosion started from this panel is running.
+	 *
+	 * @return True while the erosion task has not completed.
+	 */
+	bool IsEroding() const;
+
 };
\ No newline at end of file
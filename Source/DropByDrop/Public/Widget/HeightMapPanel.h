@@ -145,6 +145,14 @@ private:
 	 */
 	FReply OnCreateHeightmapClicked();
 
+	/**
+	 * Handles the "Export RAW" button click event.
+	 * Streams the heightmap at "ExportScale" times its resolution into a 16-bit RAW file.
+	 *
+	 * @return FReply::Handled() to indicate event processing.
+	 */
+	FReply OnExportHeightmapClicked();
+
 	/**
 	 * Handles the "Import External Heightmap" button click event.
 	 * Opens a file dialog for selecting an external heightmap image file.
@@ -85,4 +85,13 @@ private:
 	 */
 	FReply OnSplitInProxiesClicked();
 
+	/**
+	 * Handler for the "Export Heightmap" button click event.
+	 * Saves the heightmap of the active landscape as a 16-bit RAW file.
+	 * This button is only enabled when a valid landscape is selected.
+	 *
+	 * @return FReply::Handled() to indicate the event was processed.
+	 */
+	FReply OnExportHeightmapClicked();
+
 };
\ No newline at end of file
@@ -135,7 +135,8 @@ private:
 	 * Reloads and updates the heightmap preview image in the right panel.
 	 * Called after heightmap creation or modification to keep preview in sync.
 	 * Loads texture from predefined asset path and updates brush/image widget.
+	 * @param bLoadSavedHeightmap - If false, clears the preview instead of loading the saved texture.
 	 */
-	void RefreshRightPreview();
+	void RefreshRightPreview(const bool bLoadSavedHeightmap = true);
 
 };
\ No newline at end of file